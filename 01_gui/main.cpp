@@ -25,16 +25,6 @@ struct FrameResources
 
 void transition_attachments_to_initial_layout()
 {
-    const auto vk_handle_cmd_pool = vk_core::create_command_pool();
-    const auto vk_handle_cmd_buff = vk_core::allocate_command_buffer(vk_handle_cmd_pool, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
-
-    const VkCommandBufferBeginInfo cmd_buff_begin_info {
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-        .pNext = nullptr,
-        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
-        .pInheritanceInfo = nullptr,
-    };
-
     const VkImageMemoryBarrier transition_to_present_barrier {
         .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
         .pNext = nullptr,
@@ -56,34 +46,16 @@ void transition_attachments_to_initial_layout()
 
     for (auto i = 0; i < swapchain_transition_to_present_barrier_vec.size(); i++)
         swapchain_transition_to_present_barrier_vec[i].image = vk_core::get_swapchain_image(i);
-    
-    const VkSubmitInfo submit_info {
-        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-        .pNext = nullptr,
-        .waitSemaphoreCount = 0u,
-        .pWaitSemaphores = nullptr,
-        .pWaitDstStageMask = 0u,
-        .commandBufferCount = 1u,
-        .pCommandBuffers = &vk_handle_cmd_buff,
-        .signalSemaphoreCount = 0u,
-        .pSignalSemaphores = nullptr,
-    };
-
-    vkBeginCommandBuffer(vk_handle_cmd_buff, &cmd_buff_begin_info);
-
-    vkCmdPipelineBarrier(vk_handle_cmd_buff, 
-        VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-        VK_DEPENDENCY_BY_REGION_BIT,
-        0u, nullptr,
-        0u, nullptr,
-        static_cast<uint32_t>(swapchain_transition_to_present_barrier_vec.size()), swapchain_transition_to_present_barrier_vec.data());
 
-    vkEndCommandBuffer(vk_handle_cmd_buff);
-
-    vk_core::queue_submit(submit_info, VK_NULL_HANDLE);
-    vk_core::queue_wait_idle();
-
-    vk_core::destroy_command_pool(vk_handle_cmd_pool);
+    // No wait on the returned ticket - the first frame's ALL_COMMANDS barrier orders it after this submission.
+    vk_core::immediate_submit([&swapchain_transition_to_present_barrier_vec](VkCommandBuffer vk_handle_cmd_buff) {
+        vkCmdPipelineBarrier(vk_handle_cmd_buff, 
+            VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+            VK_DEPENDENCY_BY_REGION_BIT,
+            0u, nullptr,
+            0u, nullptr,
+            static_cast<uint32_t>(swapchain_transition_to_present_barrier_vec.size()), swapchain_transition_to_present_barrier_vec.data());
+    });
 }
 
 int main()
@@ -94,8 +66,15 @@ int main()
     GLFWwindow *glfw_window = glfwCreateWindow(static_cast<int>(window_dim_x), static_cast<int>(window_dim_y), "App", nullptr, nullptr);
     assert(glfw_window && "Failed to create window");
 
+    const VkPhysicalDeviceVulkan12Features features_12 {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+        .timelineSemaphore = VK_TRUE
+    };
+
     const VkPhysicalDeviceVulkan13Features features_13 {
         .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
+        .pNext = (void*)(&features_12),
+        .synchronization2 = VK_TRUE,
         .dynamicRendering = VK_TRUE
     };
 
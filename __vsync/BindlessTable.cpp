@@ -0,0 +1,356 @@
+#include "BindlessTable.hpp"
+#include "DescriptorBuffer.hpp"
+#include "DeviceAddressBuffer.hpp"
+#include "vk_core.hpp"
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <mutex>
+
+namespace
+{
+    constexpr std::array<VkDescriptorType, 3> binding_type_array {
+        VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        VK_DESCRIPTOR_TYPE_SAMPLER,
+    };
+    // Requested capacities, init() clamps them to the device limits.
+    constexpr std::array<uint32_t, 3> max_binding_capacity_array {16384u, 16384u, 256u};
+    std::array<uint32_t, 3> binding_capacity_array {0u, 0u, 0u};
+
+    struct SlotAllocator
+    {
+        uint32_t next_index {0u};
+        std::vector<uint32_t> free_index_vec;
+    };
+
+    VkDescriptorSetLayout vk_handle_desc_set_layout = VK_NULL_HANDLE;
+    VkDescriptorPool vk_handle_desc_pool = VK_NULL_HANDLE;
+    VkDescriptorSet vk_handle_desc_set = VK_NULL_HANDLE;
+
+    // Descriptor buffer backend, replaces the pool and set.
+    DeviceAddressBuffer desc_buffer;
+    void* desc_buffer_data = nullptr;
+
+    // Also guards the descriptor writes, the set has to be externally synchronized.
+    std::mutex table_mutex;
+    std::array<SlotAllocator, 3> slot_allocator_array;
+
+    uint32_t allocate_slot(bindless_table::Binding binding)
+    {
+        SlotAllocator& slot_allocator = slot_allocator_array[binding];
+
+        if (!slot_allocator.free_index_vec.empty())
+        {
+            const uint32_t index = slot_allocator.free_index_vec.back();
+            slot_allocator.free_index_vec.pop_back();
+            return index;
+        }
+
+        if (slot_allocator.next_index == binding_capacity_array[binding])
+        {
+            std::cerr << "Bindless table binding " << binding << " is full!\n";
+            exit(EXIT_FAILURE);
+        }
+
+        return slot_allocator.next_index++;
+    }
+
+    uint32_t write_slot(bindless_table::Binding binding, const VkDescriptorImageInfo* image_info, const VkDescriptorBufferInfo* buffer_info)
+    {
+        std::lock_guard lock(table_mutex);
+
+        const uint32_t index = allocate_slot(binding);
+
+        const VkWriteDescriptorSet write_desc_set {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .pNext = nullptr,
+            .dstSet = vk_handle_desc_set,
+            .dstBinding = binding,
+            .dstArrayElement = index,
+            .descriptorCount = 1u,
+            .descriptorType = binding_type_array[binding],
+            .pImageInfo = image_info,
+            .pBufferInfo = buffer_info,
+            .pTexelBufferView = nullptr,
+        };
+
+        vk_core::update_desc_sets(1u, &write_desc_set, 0u, nullptr);
+
+        return index;
+    }
+
+    uint32_t write_slot(bindless_table::Binding binding, const VkDescriptorDataEXT& descriptor_data)
+    {
+        std::lock_guard lock(table_mutex);
+
+        const uint32_t index = allocate_slot(binding);
+
+        const VkDescriptorGetInfoEXT get_info {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT,
+            .pNext = nullptr,
+            .type = binding_type_array[binding],
+            .data = descriptor_data,
+        };
+
+        descriptor_backend::write_descriptor(desc_buffer_data, vk_handle_desc_set_layout, binding, index, get_info);
+
+        return index;
+    }
+
+    // The bindings are visible to all stages, so per stage and per set limits both apply. Descriptor buffer
+    // layouts are not UPDATE_AFTER_BIND and fall under the regular limits.
+    void clamp_binding_capacities(bool descriptor_buffers)
+    {
+        const VkPhysicalDeviceLimits& limits = vk_core::get_physical_device_properties().limits;
+        const VkPhysicalDeviceDescriptorIndexingProperties& indexing_props = vk_core::get_physical_device_descriptor_indexing_properties();
+
+        const std::array<uint32_t, 3> stage_limit_array = descriptor_buffers ?
+            std::array<uint32_t, 3>{limits.maxPerStageDescriptorSampledImages, limits.maxPerStageDescriptorStorageBuffers, limits.maxPerStageDescriptorSamplers} :
+            std::array<uint32_t, 3>{indexing_props.maxPerStageDescriptorUpdateAfterBindSampledImages, indexing_props.maxPerStageDescriptorUpdateAfterBindStorageBuffers, indexing_props.maxPerStageDescriptorUpdateAfterBindSamplers};
+
+        const std::array<uint32_t, 3> set_limit_array = descriptor_buffers ?
+            std::array<uint32_t, 3>{limits.maxDescriptorSetSampledImages, limits.maxDescriptorSetStorageBuffers, limits.maxDescriptorSetSamplers} :
+            std::array<uint32_t, 3>{indexing_props.maxDescriptorSetUpdateAfterBindSampledImages, indexing_props.maxDescriptorSetUpdateAfterBindStorageBuffers, indexing_props.maxDescriptorSetUpdateAfterBindSamplers};
+
+        const uint32_t stage_resource_limit = descriptor_buffers ? limits.maxPerStageResources : indexing_props.maxPerStageUpdateAfterBindResources;
+
+        uint32_t resource_count = 0u;
+
+        for (size_t i = 0; i < binding_capacity_array.size(); i++)
+        {
+            binding_capacity_array[i] = std::min({max_binding_capacity_array[i], stage_limit_array[i], set_limit_array[i]});
+
+            if (binding_capacity_array[i] == 0u)
+            {
+                std::cerr << "Bindless table binding " << i << " is not supported by the device!\n";
+                exit(EXIT_FAILURE);
+            }
+
+            // Samplers are not resources.
+            if (binding_type_array[i] != VK_DESCRIPTOR_TYPE_SAMPLER)
+                resource_count += binding_capacity_array[i];
+        }
+
+        if (resource_count > stage_resource_limit)
+        {
+            std::cerr << "Bindless table needs " << resource_count << " resources per stage, the device supports " << stage_resource_limit << "!\n";
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // The slot is not written again until no frame can read it anymore.
+    void release_slot(bindless_table::Binding binding, uint32_t index, uint64_t timeline_value)
+    {
+        vk_core::defer_destruction(timeline_value, [binding, index]() {
+            std::lock_guard lock(table_mutex);
+            slot_allocator_array[binding].free_index_vec.push_back(index);
+        });
+    }
+};
+
+void bindless_table::init()
+{
+    // UPDATE_AFTER_BIND does not exist for descriptor buffers, their descriptors are plain memory that
+    // can be written for unused slots anyway.
+    const bool descriptor_buffers = descriptor_backend::uses_descriptor_buffers();
+
+    clamp_binding_capacities(descriptor_buffers);
+
+    std::array<VkDescriptorSetLayoutBinding, 3> binding_array;
+    std::array<VkDescriptorBindingFlags, 3> binding_flags_array;
+    std::array<VkDescriptorPoolSize, 3> pool_size_array;
+
+    for (uint32_t i = 0; i < binding_array.size(); i++)
+    {
+        binding_array[i] = {
+            .binding = i,
+            .descriptorType = binding_type_array[i],
+            .descriptorCount = binding_capacity_array[i],
+            .stageFlags = VK_SHADER_STAGE_ALL,
+            .pImmutableSamplers = nullptr,
+        };
+
+        binding_flags_array[i] = descriptor_buffers ? static_cast<VkDescriptorBindingFlags>(VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT) :
+            VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+
+        pool_size_array[i] = {binding_type_array[i], binding_capacity_array[i]};
+    }
+
+    const VkDescriptorSetLayoutBindingFlagsCreateInfo create_info_binding_flags {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+        .pNext = nullptr,
+        .bindingCount = static_cast<uint32_t>(binding_flags_array.size()),
+        .pBindingFlags = binding_flags_array.data(),
+    };
+
+    vk_handle_desc_set_layout = vk_core::create_desc_set_layout({
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .pNext = &create_info_binding_flags,
+        .flags = descriptor_buffers ? descriptor_backend::get_desc_set_layout_flags() : VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+        .bindingCount = static_cast<uint32_t>(binding_array.size()),
+        .pBindings = binding_array.data(),
+    });
+
+    if (descriptor_buffers)
+    {
+        const VkDeviceSize desc_buffer_size = vk_core::get_desc_set_layout_size_EXT(vk_handle_desc_set_layout);
+        const VkPhysicalDeviceDescriptorBufferPropertiesEXT& desc_buffer_props = vk_core::get_physical_device_descriptor_buffer_properties();
+
+        // Samplers and resources share the buffer, the whole set has to be addressable as either.
+        if (desc_buffer_size > desc_buffer_props.maxResourceDescriptorBufferRange || desc_buffer_size > desc_buffer_props.maxSamplerDescriptorBufferRange)
+        {
+            std::cerr << "Bindless table of " << desc_buffer_size << " bytes exceeds the descriptor buffer ranges of the device!\n";
+            exit(EXIT_FAILURE);
+        }
+
+        desc_buffer = DeviceAddressBuffer::create(desc_buffer_size,
+            VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT | VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        vk_core::map_memory(desc_buffer.vk_handle_memory, 0u, VK_WHOLE_SIZE, 0x0, &desc_buffer_data);
+        return;
+    }
+
+    vk_handle_desc_pool = vk_core::create_desc_pool({
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+        .maxSets = 1u,
+        .poolSizeCount = static_cast<uint32_t>(pool_size_array.size()),
+        .pPoolSizes = pool_size_array.data(),
+    });
+
+    vk_handle_desc_set = vk_core::allocate_desc_sets({
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .pNext = nullptr,
+        .descriptorPool = vk_handle_desc_pool,
+        .descriptorSetCount = 1u,
+        .pSetLayouts = &vk_handle_desc_set_layout,
+    }).front();
+}
+
+void bindless_table::destroy()
+{
+    if (desc_buffer.vk_handle_buffer != VK_NULL_HANDLE)
+    {
+        vk_core::unmap_memory(desc_buffer.vk_handle_memory);
+        desc_buffer.destroy();
+        desc_buffer_data = nullptr;
+    }
+
+    vk_core::destroy_desc_pool(vk_handle_desc_pool);
+    vk_core::destroy_desc_set_layout(vk_handle_desc_set_layout);
+
+    vk_handle_desc_pool = VK_NULL_HANDLE;
+    vk_handle_desc_set_layout = VK_NULL_HANDLE;
+    vk_handle_desc_set = VK_NULL_HANDLE;
+    slot_allocator_array = {};
+}
+
+VkDescriptorSetLayout bindless_table::get_desc_set_layout()
+{
+    return vk_handle_desc_set_layout;
+}
+
+VkDescriptorSet bindless_table::get_desc_set()
+{
+    return vk_handle_desc_set;
+}
+
+VkDeviceAddress bindless_table::get_desc_buffer_address()
+{
+    return desc_buffer.device_address;
+}
+
+VkDescriptorSetLayout bindless_table::get_compatible_desc_set_layout(const std::vector<VkDescriptorSetLayoutBinding>& binding_vec)
+{
+    for (const VkDescriptorSetLayoutBinding& binding : binding_vec)
+    {
+        if (binding.binding >= binding_type_array.size() || binding.descriptorType != binding_type_array[binding.binding] || binding.descriptorCount != 0u)
+        {
+            std::cerr << "Descriptor set with runtime arrays does not match the bindless table (binding " << binding.binding << ")!\n";
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (vk_handle_desc_set_layout == VK_NULL_HANDLE)
+    {
+        std::cerr << "Shaders use the bindless table before bindless_table::init!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    return vk_handle_desc_set_layout;
+}
+
+uint32_t bindless_table::add_sampled_image(VkImageView vk_handle_image_view, VkImageLayout image_layout)
+{
+    const VkDescriptorImageInfo image_info {VK_NULL_HANDLE, vk_handle_image_view, image_layout};
+
+    if (descriptor_backend::uses_descriptor_buffers())
+        return write_slot(SampledImages, {.pSampledImage = &image_info});
+
+    return write_slot(SampledImages, &image_info, nullptr);
+}
+
+uint32_t bindless_table::add_storage_buffer(VkBuffer vk_handle_buffer, VkDeviceSize offset, VkDeviceSize range)
+{
+    if (descriptor_backend::uses_descriptor_buffers())
+    {
+        if (range == VK_WHOLE_SIZE)
+        {
+            std::cerr << "Bindless storage buffers need an explicit range with descriptor buffers!\n";
+            exit(EXIT_FAILURE);
+        }
+
+        const VkDescriptorAddressInfoEXT address_info {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_ADDRESS_INFO_EXT,
+            .pNext = nullptr,
+            .address = vk_core::get_buffer_device_address(vk_handle_buffer) + offset,
+            .range = range,
+            .format = VK_FORMAT_UNDEFINED,
+        };
+
+        return write_slot(StorageBuffers, {.pStorageBuffer = &address_info});
+    }
+
+    const VkDescriptorBufferInfo buffer_info {vk_handle_buffer, offset, range};
+    return write_slot(StorageBuffers, nullptr, &buffer_info);
+}
+
+uint32_t bindless_table::add_sampler(VkSampler vk_handle_sampler)
+{
+    if (descriptor_backend::uses_descriptor_buffers())
+        return write_slot(Samplers, {.pSampler = &vk_handle_sampler});
+
+    const VkDescriptorImageInfo image_info {vk_handle_sampler, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_UNDEFINED};
+    return write_slot(Samplers, &image_info, nullptr);
+}
+
+void bindless_table::remove_sampled_image(uint32_t index, uint64_t timeline_value)
+{
+    release_slot(SampledImages, index, timeline_value);
+}
+
+void bindless_table::remove_storage_buffer(uint32_t index, uint64_t timeline_value)
+{
+    release_slot(StorageBuffers, index, timeline_value);
+}
+
+void bindless_table::remove_sampler(uint32_t index, uint64_t timeline_value)
+{
+    release_slot(Samplers, index, timeline_value);
+}
+
+void bindless_table::bind(VkCommandBuffer vk_handle_cmd_buff, VkPipelineBindPoint bind_point, VkPipelineLayout vk_handle_pipeline_layout, uint32_t set)
+{
+    if (descriptor_backend::uses_descriptor_buffers())
+    {
+        const uint32_t buffer_index = descriptor_backend::BindlessBufferIndex;
+        const VkDeviceSize offset = 0u;
+        vk_core::cmd_set_desc_buffer_offsets_EXT(vk_handle_cmd_buff, bind_point, vk_handle_pipeline_layout, set, 1u, &buffer_index, &offset);
+        return;
+    }
+
+    vkCmdBindDescriptorSets(vk_handle_cmd_buff, bind_point, vk_handle_pipeline_layout, set, 1u, &vk_handle_desc_set, 0u, nullptr);
+}
@@ -0,0 +1,58 @@
+#ifndef BINDLESS_TABLE_HPP
+#define BINDLESS_TABLE_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <inttypes.h>
+
+// One global descriptor set holding every sampled image, storage buffer and sampler, bound once per frame.
+// Resources get a stable index when they are added, shaders index the arrays with it (e.g. passed in push
+// constants), so draws with different materials need no descriptor set binds in between.
+//
+//     layout(set = S, binding = 0) uniform texture2D bindless_textures[];
+//     layout(set = S, binding = 1) buffer Buffer { ... } bindless_buffers[];
+//     layout(set = S, binding = 2) uniform sampler bindless_samplers[];
+//
+// Shaders declare any subset of the arrays, as runtime arrays. pipeline_layout_cache uses the table's layout
+// for the set they are in. Bindings are UPDATE_AFTER_BIND and PARTIALLY_BOUND, resources can be added while
+// frames using the set are in flight and unused slots stay unwritten. Removed slots are reused once the
+// submit timeline passes the value they are removed with. init() sizes the arrays to at most 16384 images,
+// 16384 buffers and 256 samplers, less where the device limits are lower, and exits if they cannot fit.
+//
+// On the descriptor buffer backend the set is a persistently mapped descriptor buffer instead, slots are
+// written with vkGetDescriptorEXT and bind() sets its offset (after DescriptorBufferAllocator::bind). Bindings
+// are only PARTIALLY_BOUND there, unused slots can be written while frames are in flight all the same.
+namespace bindless_table
+{
+    enum Binding : uint32_t
+    {
+        SampledImages = 0,
+        StorageBuffers,
+        Samplers,
+    };
+
+    void init();
+    void destroy();
+
+    VkDescriptorSetLayout get_desc_set_layout();
+    VkDescriptorSet get_desc_set();                 // VK_NULL_HANDLE on the descriptor buffer backend
+    VkDeviceAddress get_desc_buffer_address();      // 0 on the set based backend
+
+    // The table's layout if binding_vec only declares its arrays, exits if it declares anything else.
+    VkDescriptorSetLayout get_compatible_desc_set_layout(const std::vector<VkDescriptorSetLayoutBinding>& binding_vec);
+
+    uint32_t add_sampled_image(VkImageView vk_handle_image_view, VkImageLayout image_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    // Descriptor buffers need an explicit range and a buffer created with SHADER_DEVICE_ADDRESS usage.
+    uint32_t add_storage_buffer(VkBuffer vk_handle_buffer, VkDeviceSize offset = 0u, VkDeviceSize range = VK_WHOLE_SIZE);
+    uint32_t add_sampler(VkSampler vk_handle_sampler);
+
+    // timeline_value is the submit timeline value of the last work that may use the index.
+    void remove_sampled_image(uint32_t index, uint64_t timeline_value);
+    void remove_storage_buffer(uint32_t index, uint64_t timeline_value);
+    void remove_sampler(uint32_t index, uint64_t timeline_value);
+
+    void bind(VkCommandBuffer vk_handle_cmd_buff, VkPipelineBindPoint bind_point, VkPipelineLayout vk_handle_pipeline_layout, uint32_t set);
+};
+
+#endif
@@ -0,0 +1,199 @@
+#include "DescriptorAllocator.hpp"
+#include "DescriptorBuffer.hpp"
+#include "vk_core.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <iostream>
+
+namespace
+{
+    constexpr uint32_t initial_set_capacity = 64u;
+
+    // Descriptors of each type the first pool holds per set. Later pools are sized from what the frames
+    // allocated, a pool that runs out of one type before it runs out of sets is chained like a full one.
+    constexpr std::array<VkDescriptorPoolSize, 6> initial_desc_count_per_set {{
+        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2u},
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2u},
+        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4u},
+        {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 2u},
+        {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1u},
+        {VK_DESCRIPTOR_TYPE_SAMPLER, 1u},
+    }};
+
+    uint32_t& get_desc_count(std::vector<VkDescriptorPoolSize>& desc_count_vec, VkDescriptorType type)
+    {
+        const auto it = std::find_if(desc_count_vec.begin(), desc_count_vec.end(), [type](const VkDescriptorPoolSize& desc_count) {
+            return desc_count.type == type;
+        });
+
+        return (it != desc_count_vec.end()) ? it->descriptorCount : desc_count_vec.emplace_back(VkDescriptorPoolSize{type, 0u}).descriptorCount;
+    }
+
+    // Descriptors of each type in a set with the bindings.
+    std::vector<VkDescriptorPoolSize> get_desc_counts(const std::vector<VkDescriptorSetLayoutBinding>& binding_vec)
+    {
+        std::vector<VkDescriptorPoolSize> desc_count_vec;
+
+        for (const VkDescriptorSetLayoutBinding& binding : binding_vec)
+        {
+            // Runtime arrays are the bindless table, it has its own pool.
+            if (binding.descriptorCount == 0u)
+            {
+                std::cerr << "Transient descriptor sets cannot hold runtime arrays (binding " << binding.binding << ")!\n";
+                exit(EXIT_FAILURE);
+            }
+
+            get_desc_count(desc_count_vec, binding.descriptorType) += binding.descriptorCount;
+        }
+
+        return desc_count_vec;
+    }
+};
+
+VkDescriptorPool DescriptorAllocator::create_pool(const PoolCapacity& capacity)
+{
+    std::vector<VkDescriptorPoolSize> pool_size_vec;
+
+    for (const VkDescriptorPoolSize& desc_count : capacity.desc_count_vec)
+    {
+        if (desc_count.descriptorCount > 0u)
+            pool_size_vec.push_back(desc_count);
+    }
+
+    const VkDescriptorPoolCreateInfo create_info {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0x0,
+        .maxSets = capacity.set_count,
+        .poolSizeCount = static_cast<uint32_t>(pool_size_vec.size()),
+        .pPoolSizes = pool_size_vec.data(),
+    };
+
+    m_pool_capacity_vec.push_back(capacity);
+
+    return m_pool_vec.emplace_back(vk_core::create_desc_pool(create_info));
+}
+
+VkDescriptorSet DescriptorAllocator::allocate(VkDescriptorSetLayout vk_handle_desc_set_layout, const std::vector<VkDescriptorSetLayoutBinding>& binding_vec)
+{
+    // Layouts created for descriptor buffers cannot be allocated from pools.
+    if (descriptor_backend::uses_descriptor_buffers())
+    {
+        std::cerr << "DescriptorAllocator is not available on the descriptor buffer backend, use DescriptorBufferAllocator!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    const std::vector<VkDescriptorPoolSize> desc_count_vec = get_desc_counts(binding_vec);
+
+    if (m_pool_vec.empty())
+    {
+        PoolCapacity capacity {.set_count = initial_set_capacity, .desc_count_vec = {}};
+
+        for (const VkDescriptorPoolSize& desc_count : initial_desc_count_per_set)
+            capacity.desc_count_vec.push_back({desc_count.type, desc_count.descriptorCount * initial_set_capacity});
+
+        create_pool(capacity);
+    }
+
+    VkDescriptorSetAllocateInfo alloc_info {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .pNext = nullptr,
+        .descriptorPool = m_pool_vec.back(),
+        .descriptorSetCount = 1u,
+        .pSetLayouts = &vk_handle_desc_set_layout,
+    };
+
+    VkDescriptorSet vk_handle_desc_set = VK_NULL_HANDLE;
+    VkResult result = vk_core::allocate_desc_sets(alloc_info, &vk_handle_desc_set);
+
+    if (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL)
+    {
+        // Twice the last pool, with room for this set even if its types were not in the pool yet.
+        PoolCapacity capacity = m_pool_capacity_vec.back();
+        capacity.set_count *= 2u;
+
+        for (VkDescriptorPoolSize& desc_count : capacity.desc_count_vec)
+            desc_count.descriptorCount *= 2u;
+
+        for (const VkDescriptorPoolSize& desc_count : desc_count_vec)
+        {
+            uint32_t& capacity_desc_count = get_desc_count(capacity.desc_count_vec, desc_count.type);
+            capacity_desc_count = std::max(capacity_desc_count, std::bit_ceil(desc_count.descriptorCount));
+        }
+
+        alloc_info.descriptorPool = create_pool(capacity);
+        result = vk_core::allocate_desc_sets(alloc_info, &vk_handle_desc_set);
+    }
+
+    if (result != VK_SUCCESS)
+    {
+        std::cerr << "Failed to allocate a transient descriptor set (VkResult " << result << ")!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    m_usage.set_count++;
+
+    for (const VkDescriptorPoolSize& desc_count : desc_count_vec)
+        get_desc_count(m_usage.desc_count_vec, desc_count.type) += desc_count.descriptorCount;
+
+    return vk_handle_desc_set;
+}
+
+void DescriptorAllocator::reset()
+{
+    m_peak_usage.set_count = std::max(m_peak_usage.set_count, m_usage.set_count);
+
+    for (const VkDescriptorPoolSize& desc_count : m_usage.desc_count_vec)
+    {
+        uint32_t& peak_desc_count = get_desc_count(m_peak_usage.desc_count_vec, desc_count.type);
+        peak_desc_count = std::max(peak_desc_count, desc_count.descriptorCount);
+    }
+
+    // The frame overflowed the first pool, replace the chain with one pool that fits the peak.
+    if (m_pool_vec.size() > 1u)
+    {
+        PoolCapacity capacity {.set_count = std::bit_ceil(m_peak_usage.set_count), .desc_count_vec = {}};
+
+        for (const VkDescriptorPoolSize& desc_count : m_peak_usage.desc_count_vec)
+            get_desc_count(capacity.desc_count_vec, desc_count.type) = std::bit_ceil(desc_count.descriptorCount);
+
+        // Never smaller than the chain, it held the frame.
+        PoolCapacity chain_capacity;
+
+        for (const PoolCapacity& pool_capacity : m_pool_capacity_vec)
+        {
+            chain_capacity.set_count += pool_capacity.set_count;
+
+            for (const VkDescriptorPoolSize& desc_count : pool_capacity.desc_count_vec)
+                get_desc_count(chain_capacity.desc_count_vec, desc_count.type) += desc_count.descriptorCount;
+        }
+
+        capacity.set_count = std::max(capacity.set_count, chain_capacity.set_count);
+
+        for (const VkDescriptorPoolSize& desc_count : chain_capacity.desc_count_vec)
+        {
+            uint32_t& capacity_desc_count = get_desc_count(capacity.desc_count_vec, desc_count.type);
+            capacity_desc_count = std::max(capacity_desc_count, desc_count.descriptorCount);
+        }
+
+        destroy();
+        create_pool(capacity);
+    }
+    else if (!m_pool_vec.empty())
+    {
+        vk_core::reset_desc_pool(m_pool_vec.front());
+    }
+
+    m_usage = {};
+}
+
+void DescriptorAllocator::destroy()
+{
+    for (const VkDescriptorPool vk_handle_desc_pool : m_pool_vec)
+        vk_core::destroy_desc_pool(vk_handle_desc_pool);
+
+    m_pool_vec.clear();
+    m_pool_capacity_vec.clear();
+}
@@ -0,0 +1,45 @@
+#ifndef DESCRIPTOR_ALLOCATOR_HPP
+#define DESCRIPTOR_ALLOCATOR_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <inttypes.h>
+
+// Transient descriptor sets for one frame in flight. Sets are never freed one by one, the pools are
+// created without FREE_DESCRIPTOR_SET_BIT so the driver can allocate linearly, and reset() returns
+// everything once the frame's fence signaled.
+//
+// A frame that runs out of space chains another pool twice the size. The next reset() replaces the
+// chain with a single pool sized for the peak number of sets and of descriptors of each type, never
+// smaller than the chain it replaces, so the steady state is one pool and one vkResetDescriptorPool per
+// frame. Not thread safe, the frame's recording thread owns it. Set based backend only, allocate() exits on
+// the descriptor buffer backend (DescriptorBufferAllocator takes its place).
+struct DescriptorAllocator
+{
+private:
+    struct PoolCapacity
+    {
+        uint32_t set_count {0u};
+        std::vector<VkDescriptorPoolSize> desc_count_vec;
+    };
+
+    std::vector<VkDescriptorPool> m_pool_vec;           // sets come from the last pool, the ones before are full
+    std::vector<PoolCapacity> m_pool_capacity_vec;
+    PoolCapacity m_usage;                               // allocated since the last reset
+    PoolCapacity m_peak_usage;
+
+    VkDescriptorPool create_pool(const PoolCapacity& capacity);
+public:
+    // binding_vec are the bindings the layout was created with (e.g. ShaderInterface::desc_set_binding_map),
+    // their descriptor counts size the pools.
+    VkDescriptorSet allocate(VkDescriptorSetLayout vk_handle_desc_set_layout, const std::vector<VkDescriptorSetLayoutBinding>& binding_vec);
+
+    // Call once the GPU finished the frame, every set allocated since the last reset becomes invalid.
+    void reset();
+    void destroy();
+
+    uint32_t get_pool_count() const { return static_cast<uint32_t>(m_pool_vec.size()); }
+};
+
+#endif
@@ -0,0 +1,191 @@
+#include "DescriptorBuffer.hpp"
+#include "BindlessTable.hpp"
+#include "vk_core.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    constexpr VkDeviceSize initial_buffer_size = 256u * 1024u;
+
+    constexpr VkBufferUsageFlags desc_buffer_usage = VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT | VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT;
+
+    // Devices without bufferlessPushDescriptors keep push descriptors in a bound descriptor buffer, the frame's.
+    VkBufferUsageFlags get_frame_buffer_usage()
+    {
+        if (vk_core::is_device_extension_enabled(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME) &&
+            vk_core::get_physical_device_descriptor_buffer_properties().bufferlessPushDescriptors == VK_FALSE)
+            return desc_buffer_usage | VK_BUFFER_USAGE_PUSH_DESCRIPTORS_DESCRIPTOR_BUFFER_BIT_EXT;
+
+        return desc_buffer_usage;
+    }
+
+    // The frame's buffer and the bindless table's are both bound with sampler and resource usage, so each
+    // counts against the sampler and the resource buffer bindings. The spec only guarantees one of each.
+    bool has_desc_buffer_bindings()
+    {
+        const VkPhysicalDeviceDescriptorBufferPropertiesEXT& props = vk_core::get_physical_device_descriptor_buffer_properties();
+        constexpr uint32_t buffer_count = 2u;
+
+        if (props.maxDescriptorBufferBindings >= buffer_count && props.maxSamplerDescriptorBufferBindings >= buffer_count &&
+            props.maxResourceDescriptorBufferBindings >= buffer_count)
+            return true;
+
+        std::cout << "Descriptor buffers bind at most " << props.maxSamplerDescriptorBufferBindings << " sampler and "
+                  << props.maxResourceDescriptorBufferBindings << " resource buffers, using descriptor sets.\n";
+        return false;
+    }
+
+    VkDeviceSize align_offset(VkDeviceSize offset)
+    {
+        const VkDeviceSize alignment = vk_core::get_physical_device_descriptor_buffer_properties().descriptorBufferOffsetAlignment;
+        return (offset + alignment - 1u) / alignment * alignment;
+    }
+};
+
+bool descriptor_backend::uses_descriptor_buffers()
+{
+    static const bool descriptor_buffers = vk_core::is_device_extension_enabled(VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME) && has_desc_buffer_bindings();
+    return descriptor_buffers;
+}
+
+VkDescriptorSetLayoutCreateFlags descriptor_backend::get_desc_set_layout_flags()
+{
+    return uses_descriptor_buffers() ? static_cast<VkDescriptorSetLayoutCreateFlags>(VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT) : 0x0u;
+}
+
+VkPipelineCreateFlags descriptor_backend::get_pipeline_create_flags()
+{
+    return uses_descriptor_buffers() ? static_cast<VkPipelineCreateFlags>(VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT) : 0x0u;
+}
+
+size_t descriptor_backend::get_descriptor_size(VkDescriptorType type)
+{
+    const VkPhysicalDeviceDescriptorBufferPropertiesEXT& props = vk_core::get_physical_device_descriptor_buffer_properties();
+
+    switch (type)
+    {
+        case VK_DESCRIPTOR_TYPE_SAMPLER:                    return props.samplerDescriptorSize;
+        case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:     return props.combinedImageSamplerDescriptorSize;
+        case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:              return props.sampledImageDescriptorSize;
+        case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:              return props.storageImageDescriptorSize;
+        case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:       return props.uniformTexelBufferDescriptorSize;
+        case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:       return props.storageTexelBufferDescriptorSize;
+        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:             return props.uniformBufferDescriptorSize;
+        case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:             return props.storageBufferDescriptorSize;
+        case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:           return props.inputAttachmentDescriptorSize;
+        case VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR: return props.accelerationStructureDescriptorSize;
+        default:
+            std::cerr << "Descriptor type " << type << " is not supported by descriptor buffers!\n";
+            exit(EXIT_FAILURE);
+    }
+}
+
+void descriptor_backend::write_descriptor(void* p_set, VkDescriptorSetLayout vk_handle_desc_set_layout, uint32_t binding, uint32_t array_element, const VkDescriptorGetInfoEXT& get_info)
+{
+    const size_t descriptor_size = get_descriptor_size(get_info.type);
+    const VkDeviceSize binding_offset = vk_core::get_desc_set_layout_binding_offset_EXT(vk_handle_desc_set_layout, binding);
+
+    vk_core::get_descriptor_EXT(get_info, descriptor_size, static_cast<uint8_t*>(p_set) + binding_offset + array_element * descriptor_size);
+}
+
+void DescriptorBufferAllocator::create_buffer(VkDeviceSize size)
+{
+    m_buffer = DeviceAddressBuffer::create(size, get_frame_buffer_usage(), VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+    void* mapped_data = nullptr;
+    vk_core::map_memory(m_buffer.vk_handle_memory, 0u, VK_WHOLE_SIZE, 0x0, &mapped_data);
+    m_mapped_data = static_cast<uint8_t*>(mapped_data);
+}
+
+VkDeviceSize DescriptorBufferAllocator::allocate(VkDescriptorSetLayout vk_handle_desc_set_layout)
+{
+    if (m_buffer.vk_handle_buffer == VK_NULL_HANDLE)
+        create_buffer(initial_buffer_size);
+
+    const VkDeviceSize set_offset = align_offset(m_offset);
+    const VkDeviceSize set_size = vk_core::get_desc_set_layout_size_EXT(vk_handle_desc_set_layout);
+
+    if (set_offset + set_size > m_buffer.size)
+    {
+        std::cerr << "Frame descriptor buffer of " << m_buffer.size << " bytes is full!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    m_offset = set_offset + set_size;
+
+    return set_offset;
+}
+
+void DescriptorBufferAllocator::write(VkDeviceSize set_offset, VkDescriptorSetLayout vk_handle_desc_set_layout, uint32_t binding, uint32_t array_element, const VkDescriptorGetInfoEXT& get_info)
+{
+    descriptor_backend::write_descriptor(m_mapped_data + set_offset, vk_handle_desc_set_layout, binding, array_element, get_info);
+}
+
+void DescriptorBufferAllocator::bind(VkCommandBuffer vk_handle_cmd_buff)
+{
+    if (m_buffer.vk_handle_buffer == VK_NULL_HANDLE)
+        create_buffer(initial_buffer_size);
+
+    VkDescriptorBufferBindingPushDescriptorBufferHandleEXT push_desc_buffer_handle {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_BUFFER_BINDING_PUSH_DESCRIPTOR_BUFFER_HANDLE_EXT,
+        .pNext = nullptr,
+        .buffer = m_buffer.vk_handle_buffer,
+    };
+
+    const VkBufferUsageFlags usage = get_frame_buffer_usage();
+
+    std::vector<VkDescriptorBufferBindingInfoEXT> binding_info_vec {{
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_BUFFER_BINDING_INFO_EXT,
+        .pNext = (usage & VK_BUFFER_USAGE_PUSH_DESCRIPTORS_DESCRIPTOR_BUFFER_BIT_EXT) ? &push_desc_buffer_handle : nullptr,
+        .address = m_buffer.device_address,
+        .usage = usage,
+    }};
+
+    if (bindless_table::get_desc_buffer_address() != 0u)
+    {
+        binding_info_vec.push_back({
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_BUFFER_BINDING_INFO_EXT,
+            .pNext = nullptr,
+            .address = bindless_table::get_desc_buffer_address(),
+            .usage = desc_buffer_usage,
+        });
+    }
+
+    vk_core::cmd_bind_desc_buffers_EXT(vk_handle_cmd_buff, binding_info_vec);
+}
+
+void DescriptorBufferAllocator::set_offset(VkCommandBuffer vk_handle_cmd_buff, VkPipelineBindPoint bind_point, VkPipelineLayout vk_handle_pipeline_layout, uint32_t set, VkDeviceSize set_offset)
+{
+    const uint32_t buffer_index = descriptor_backend::FrameBufferIndex;
+    vk_core::cmd_set_desc_buffer_offsets_EXT(vk_handle_cmd_buff, bind_point, vk_handle_pipeline_layout, set, 1u, &buffer_index, &set_offset);
+}
+
+void DescriptorBufferAllocator::reset()
+{
+    m_peak_offset = std::max(m_peak_offset, m_offset);
+
+    // The fence signaled, nothing reads the old buffer anymore.
+    if (m_peak_offset > m_buffer.size / 2u && m_buffer.vk_handle_buffer != VK_NULL_HANDLE)
+    {
+        const VkDeviceSize size = m_buffer.size * 2u;
+        destroy();
+        create_buffer(size);
+    }
+
+    m_offset = 0u;
+}
+
+void DescriptorBufferAllocator::destroy()
+{
+    if (m_buffer.vk_handle_buffer != VK_NULL_HANDLE)
+    {
+        vk_core::unmap_memory(m_buffer.vk_handle_memory);
+        m_buffer.destroy();
+    }
+
+    m_mapped_data = nullptr;
+    m_peak_offset = 0u;
+}
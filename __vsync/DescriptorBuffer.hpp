@@ -0,0 +1,73 @@
+#ifndef DESCRIPTOR_BUFFER_HPP
+#define DESCRIPTOR_BUFFER_HPP
+
+#include <vulkan/vulkan.h>
+
+#include "DeviceAddressBuffer.hpp"
+
+#include <inttypes.h>
+
+// Descriptor binding backend, chosen once from the enabled extensions and the descriptor buffer binding
+// limits (the frame's and the bindless table's buffer are bound together). With VK_EXT_descriptor_buffer,
+// descriptors are written with vkGetDescriptorEXT straight into host visible buffers and sets are bound as
+// offsets into them, there are no pools, sets or vkUpdateDescriptorSets. Without it everything stays set
+// based (DescriptorAllocator, DescriptorUpdateTemplate).
+//
+// The backend decides how set layouts and pipelines are created, pipeline_layout_cache and the pipeline
+// compilers add the flags below, so a layout from pipeline_layout_cache is only usable with the active
+// backend. Dynamic uniform/storage buffers are not supported by descriptor buffers.
+namespace descriptor_backend
+{
+    // Buffer binding indices of vkCmdBindDescriptorBuffersEXT.
+    enum BufferIndex : uint32_t
+    {
+        FrameBufferIndex = 0,       // DescriptorBufferAllocator of the frame
+        BindlessBufferIndex = 1,    // bindless_table
+    };
+
+    bool uses_descriptor_buffers();
+
+    VkDescriptorSetLayoutCreateFlags get_desc_set_layout_flags();
+    VkPipelineCreateFlags get_pipeline_create_flags();
+
+    // Size of a descriptor of type in a descriptor buffer, from VkPhysicalDeviceDescriptorBufferPropertiesEXT.
+    size_t get_descriptor_size(VkDescriptorType type);
+
+    // Writes the descriptor of get_info to binding[array_element] of the set at p_set.
+    void write_descriptor(void* p_set, VkDescriptorSetLayout vk_handle_desc_set_layout, uint32_t binding, uint32_t array_element, const VkDescriptorGetInfoEXT& get_info);
+};
+
+// Transient descriptor sets for one frame in flight on the descriptor buffer backend, the counterpart of
+// DescriptorAllocator. Sets are bump allocated from one persistently mapped buffer and reset() rewinds it
+// once the frame's fence signaled.
+//
+// Set offsets are only valid for the buffer that is bound, so the buffer cannot be replaced mid frame. A
+// frame that used more than half of it gets a buffer twice the size on the next reset(), running out
+// within a frame exits. Not thread safe, the frame's recording thread owns it.
+struct DescriptorBufferAllocator
+{
+private:
+    DeviceAddressBuffer m_buffer;
+    uint8_t* m_mapped_data {nullptr};
+    VkDeviceSize m_offset {0u};         // allocated since the last reset
+    VkDeviceSize m_peak_offset {0u};
+
+    void create_buffer(VkDeviceSize size);
+public:
+    // Offset of a set with the layout, valid until the next reset.
+    VkDeviceSize allocate(VkDescriptorSetLayout vk_handle_desc_set_layout);
+
+    void write(VkDeviceSize set_offset, VkDescriptorSetLayout vk_handle_desc_set_layout, uint32_t binding, uint32_t array_element, const VkDescriptorGetInfoEXT& get_info);
+
+    // Binds the frame's buffer and the bindless table's, once per command buffer before set_offset.
+    void bind(VkCommandBuffer vk_handle_cmd_buff);
+    void set_offset(VkCommandBuffer vk_handle_cmd_buff, VkPipelineBindPoint bind_point, VkPipelineLayout vk_handle_pipeline_layout, uint32_t set, VkDeviceSize set_offset);
+
+    // Call once the GPU finished the frame, every set allocated since the last reset becomes invalid.
+    void reset();
+    void destroy();
+
+    VkDeviceSize get_size() const { return m_buffer.size; }
+};
+
+#endif
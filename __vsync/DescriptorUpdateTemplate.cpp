@@ -0,0 +1,133 @@
+#include "DescriptorUpdateTemplate.hpp"
+#include "DescriptorBuffer.hpp"
+#include "Hash.hpp"
+#include "PipelineLayoutCache.hpp"
+#include "SpirvReflection.hpp"
+#include "vk_core.hpp"
+
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+
+namespace
+{
+    std::mutex cache_mutex;
+    std::unordered_map<uint64_t, DescriptorUpdateTemplate> template_map; // bindings hash -> template
+
+    size_t get_desc_info_size(VkDescriptorType desc_type)
+    {
+        switch (desc_type)
+        {
+            case VK_DESCRIPTOR_TYPE_SAMPLER:
+            case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+            case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+            case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+            case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+                return sizeof(VkDescriptorImageInfo);
+            case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+            case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+            case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+            case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+                return sizeof(VkDescriptorBufferInfo);
+            case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+            case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+                return sizeof(VkBufferView);
+            default:
+                std::cerr << "Descriptor type " << desc_type << " is not supported by descriptor update templates!\n";
+                exit(EXIT_FAILURE);
+        }
+    }
+};
+
+void DescriptorUpdateTemplate::update(VkDescriptorSet vk_handle_desc_set, const void* data, size_t size) const
+{
+    if (size != data_size)
+    {
+        std::cerr << "Descriptor data is " << size << " bytes, the set layout needs " << data_size << "!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    vk_core::update_desc_set_with_template(vk_handle_desc_set, vk_handle_desc_update_template, data);
+}
+
+const DescriptorUpdateTemplate& desc_update_template_cache::get(const std::vector<VkDescriptorSetLayoutBinding>& binding_vec)
+{
+    // Layouts created for descriptor buffers can not back a descriptor set, sets are written with
+    // DescriptorBufferAllocator::write there.
+    if (descriptor_backend::uses_descriptor_buffers())
+    {
+        std::cerr << "Descriptor update templates are not available with the descriptor buffer backend!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    Hasher hasher;
+    hasher.add(binding_vec);
+
+    std::lock_guard lock(cache_mutex);
+
+    if (const auto it = template_map.find(hasher.value); it != template_map.end())
+        return it->second;
+
+    // Bindings are sorted by binding index, the data struct declares them in the same order.
+    std::vector<VkDescriptorUpdateTemplateEntry> entry_vec;
+    size_t data_size = 0u;
+
+    for (const VkDescriptorSetLayoutBinding& binding : binding_vec)
+    {
+        if (binding.descriptorCount == 0u)
+        {
+            std::cerr << "Runtime arrays are written with bindless_table, not with descriptor update templates!\n";
+            exit(EXIT_FAILURE);
+        }
+
+        const size_t info_size = get_desc_info_size(binding.descriptorType);
+
+        entry_vec.push_back({
+            .dstBinding = binding.binding,
+            .dstArrayElement = 0u,
+            .descriptorCount = binding.descriptorCount,
+            .descriptorType = binding.descriptorType,
+            .offset = data_size,
+            .stride = info_size,
+        });
+
+        data_size += info_size * binding.descriptorCount;
+    }
+
+    const VkDescriptorSetLayout vk_handle_desc_set_layout = pipeline_layout_cache::get_desc_set_layout(binding_vec);
+
+    const VkDescriptorUpdateTemplateCreateInfo create_info {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0x0,
+        .descriptorUpdateEntryCount = static_cast<uint32_t>(entry_vec.size()),
+        .pDescriptorUpdateEntries = entry_vec.data(),
+        .templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET,
+        .descriptorSetLayout = vk_handle_desc_set_layout,
+        .pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS, // only used by push descriptor templates
+        .pipelineLayout = VK_NULL_HANDLE,
+        .set = 0u,
+    };
+
+    return template_map.emplace(hasher.value, DescriptorUpdateTemplate {
+        .vk_handle_desc_update_template = vk_core::create_desc_update_template(create_info),
+        .vk_handle_desc_set_layout = vk_handle_desc_set_layout,
+        .data_size = data_size,
+    }).first->second;
+}
+
+const DescriptorUpdateTemplate& desc_update_template_cache::get(const ShaderInterface& shader_interface, uint32_t set)
+{
+    const auto it = shader_interface.desc_set_binding_map.find(set);
+    return get((it != shader_interface.desc_set_binding_map.end()) ? it->second : std::vector<VkDescriptorSetLayoutBinding>{});
+}
+
+void desc_update_template_cache::destroy()
+{
+    std::lock_guard lock(cache_mutex);
+
+    for (const auto& [hash, desc_update_template] : template_map)
+        vk_core::destroy_desc_update_template(desc_update_template.vk_handle_desc_update_template);
+
+    template_map.clear();
+}
@@ -0,0 +1,52 @@
+#ifndef DESCRIPTOR_UPDATE_TEMPLATE_HPP
+#define DESCRIPTOR_UPDATE_TEMPLATE_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <type_traits>
+#include <vector>
+#include <inttypes.h>
+#include <stddef.h>
+
+struct ShaderInterface;
+
+// Writes every descriptor of a set with one vkUpdateDescriptorSetWithTemplate call from a struct of
+// descriptor infos. The struct has one member per binding, in binding order, of the info type the
+// descriptor type takes:
+//
+//     samplers, images           VkDescriptorImageInfo
+//     uniform / storage buffers  VkDescriptorBufferInfo
+//     texel buffers              VkBufferView
+//
+// Arrayed bindings take a std::array of descriptorCount infos. All three types are 8 byte aligned, so the
+// struct has no padding and its size is checked against the layout on update.
+struct DescriptorUpdateTemplate
+{
+    VkDescriptorUpdateTemplate vk_handle_desc_update_template;
+    VkDescriptorSetLayout vk_handle_desc_set_layout;
+    size_t data_size;
+
+    void update(VkDescriptorSet vk_handle_desc_set, const void* data, size_t size) const;
+
+    template<typename T>
+    void update(VkDescriptorSet vk_handle_desc_set, const T& data) const
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "descriptor data has to be a plain struct of descriptor infos");
+        update(vk_handle_desc_set, &data, sizeof(T));
+    }
+};
+
+// Templates built from set layout bindings, deduplicated by content like the set layouts they are created
+// for. The cache owns the templates, they live until destroy(). Set based backend only, get() exits when
+// descriptor_backend::uses_descriptor_buffers().
+namespace desc_update_template_cache
+{
+    const DescriptorUpdateTemplate& get(const std::vector<VkDescriptorSetLayoutBinding>& binding_vec);
+
+    // Template for a set the shaders of a program declare.
+    const DescriptorUpdateTemplate& get(const ShaderInterface& shader_interface, uint32_t set);
+
+    void destroy();
+};
+
+#endif
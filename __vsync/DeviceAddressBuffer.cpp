@@ -0,0 +1,35 @@
+#include "DeviceAddressBuffer.hpp"
+#include "vk_core.hpp"
+
+DeviceAddressBuffer DeviceAddressBuffer::create(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags memory_flags)
+{
+    DeviceAddressBuffer buffer;
+
+    buffer.vk_handle_buffer = vk_core::create_buffer({
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0x0,
+        .size = size,
+        .usage = usage | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = 0u,
+        .pQueueFamilyIndices = nullptr,
+    });
+
+    VkDeviceSize allocation_size = 0u;
+    buffer.vk_handle_memory = vk_core::allocate_buffer_memory(buffer.vk_handle_buffer, memory_flags, allocation_size, VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT);
+    vk_core::bind_buffer_memory(buffer.vk_handle_buffer, buffer.vk_handle_memory);
+
+    buffer.size = size;
+    buffer.device_address = vk_core::get_buffer_device_address(buffer.vk_handle_buffer);
+
+    return buffer;
+}
+
+void DeviceAddressBuffer::destroy()
+{
+    vk_core::destroy_buffer(vk_handle_buffer);
+    vk_core::free_memory(vk_handle_memory);
+
+    *this = {};
+}
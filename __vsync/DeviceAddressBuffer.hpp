@@ -0,0 +1,34 @@
+#ifndef DEVICE_ADDRESS_BUFFER_HPP
+#define DEVICE_ADDRESS_BUFFER_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <inttypes.h>
+
+// Buffer that shaders reach through its 64 bit device address (GL_EXT_buffer_reference) instead of a
+// descriptor. Created with SHADER_DEVICE_ADDRESS usage and its memory with DEVICE_ADDRESS_BIT.
+struct DeviceAddressBuffer
+{
+    VkBuffer vk_handle_buffer {VK_NULL_HANDLE};
+    VkDeviceMemory vk_handle_memory {VK_NULL_HANDLE};
+    VkDeviceSize size {0u};
+    VkDeviceAddress device_address {0u};
+
+    // usage is extended with VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT.
+    static DeviceAddressBuffer create(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags memory_flags);
+
+    VkDeviceAddress get_address(VkDeviceSize offset = 0u) const { return device_address + offset; }
+
+    // The caller makes sure no frame in flight reads the buffer anymore, e.g. with vk_core::defer_destruction.
+    void destroy();
+};
+
+// Device address as a push constant or buffer member. uint64_t in GLSL, or a buffer_reference, both 8 byte
+// aligned, so the struct it is in keeps the offsets std430 gives it. Push such a struct with
+// vk_core::cmd_push_constants.
+struct alignas(8) DevicePointer
+{
+    VkDeviceAddress address;
+};
+
+#endif
@@ -4,6 +4,9 @@
 #include <vulkan/vulkan.h>
 #include <memory>
 
+#include "DescriptorAllocator.hpp"
+#include "DescriptorBuffer.hpp"
+
 struct FrameResources
 {
 public:
@@ -18,6 +21,11 @@ public:
 #ifdef DEBUG
     const VkQueryPool     vk_handle_query_pool {VK_NULL_HANDLE};
 #endif
+
+    // Reset with the command pool once vk_handle_fence signaled, desc_buffer_allocator on the descriptor
+    // buffer backend, desc_allocator otherwise.
+    DescriptorAllocator   desc_allocator;
+    DescriptorBufferAllocator desc_buffer_allocator;
 };
 
 #endif
\ No newline at end of file
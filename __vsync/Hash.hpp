@@ -0,0 +1,42 @@
+#ifndef HASH_HPP
+#define HASH_HPP
+
+#include <string>
+#include <vector>
+#include <inttypes.h>
+#include <stddef.h>
+
+// FNV-1a. Structs are hashed as raw bytes, only use it with plain data that has no padding.
+struct Hasher
+{
+    uint64_t value = 14695981039346656037lu;
+
+    void add(const void* data, size_t size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+        for (size_t i = 0; i < size; i++)
+        {
+            value ^= bytes[i];
+            value *= 1099511628211lu;
+        }
+    }
+
+    template<typename T>
+    void add(const T& data) { add(&data, sizeof(T)); }
+
+    template<typename T>
+    void add(const std::vector<T>& data_vec)
+    {
+        add(data_vec.size());
+        add(data_vec.data(), data_vec.size() * sizeof(T));
+    }
+
+    void add(const std::string& str)
+    {
+        add(str.size());
+        add(str.data(), str.size());
+    }
+};
+
+#endif
@@ -0,0 +1,302 @@
+#include "ObjectCache.hpp"
+#include "Hash.hpp"
+#include "vk_core.hpp"
+
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+
+namespace
+{
+    template<typename T>
+    struct ObjectEntry
+    {
+        T vk_handle;
+        uint32_t ref_count;
+    };
+
+    // One per object type, objects are looked up by create info hash on acquire and by handle on release.
+    template<typename T>
+    struct ObjectMap
+    {
+        std::unordered_map<uint64_t, ObjectEntry<T>> entry_map;  // create info hash -> object
+        std::unordered_map<T, uint64_t> hash_map;                // object -> create info hash
+
+        T reference(uint64_t hash)
+        {
+            auto& entry = entry_map.at(hash);
+            entry.ref_count++;
+            return entry.vk_handle;
+        }
+
+        void insert(uint64_t hash, T vk_handle)
+        {
+            entry_map[hash] = {vk_handle, 0u};
+            hash_map[vk_handle] = hash;
+        }
+
+        // Returns the entry the reference was dropped from, nullptr if it had none. Objects destroy() already
+        // destroyed are skipped, deferred releases may run after it.
+        ObjectEntry<T>* unreference(T vk_handle, const char* type_name)
+        {
+            const auto hash_it = hash_map.find(vk_handle);
+
+            if (hash_it == hash_map.end())
+                return nullptr;
+
+            auto& entry = entry_map.at(hash_it->second);
+
+            if (entry.ref_count == 0u)
+            {
+                std::cerr << type_name << " released more often than acquired!\n";
+                return nullptr;
+            }
+
+            entry.ref_count--;
+            return &entry;
+        }
+
+        template<typename F>
+        void erase_unreferenced(F&& destroy_func)
+        {
+            std::erase_if(entry_map, [&](const auto& hash_entry) {
+                const ObjectEntry<T>& entry = hash_entry.second;
+
+                if (entry.ref_count > 0u)
+                    return false;
+
+                hash_map.erase(entry.vk_handle);
+                destroy_func(entry.vk_handle);
+                return true;
+            });
+        }
+
+        template<typename F>
+        void clear(const char* type_name, F&& destroy_func)
+        {
+            for (const auto& [hash, entry] : entry_map)
+            {
+                if (entry.ref_count > 0u)
+                    std::cerr << "Destroying " << type_name << " with " << entry.ref_count << " references!\n";
+
+                destroy_func(entry.vk_handle);
+            }
+
+            entry_map.clear();
+            hash_map.clear();
+        }
+    };
+
+    std::mutex cache_mutex;
+    ObjectMap<VkSampler> sampler_map;
+    ObjectMap<VkImageView> image_view_map;
+    ObjectMap<VkDescriptorSetLayout> desc_set_layout_map;
+
+    void trim_locked()
+    {
+        sampler_map.erase_unreferenced([](VkSampler vk_handle_sampler) { vk_core::destroy_sampler(vk_handle_sampler); });
+        desc_set_layout_map.erase_unreferenced([](VkDescriptorSetLayout vk_handle_desc_set_layout) { vk_core::destroy_desc_set_layout(vk_handle_desc_set_layout); });
+    }
+
+    // Create infos have padding after sType, they are hashed member by member.
+    void add_pnext_chain(Hasher& hasher, const void* p_next)
+    {
+        for (const VkBaseInStructure* p_struct = static_cast<const VkBaseInStructure*>(p_next); p_struct != nullptr; p_struct = p_struct->pNext)
+        {
+            hasher.add(p_struct->sType);
+
+            switch (p_struct->sType)
+            {
+                case VK_STRUCTURE_TYPE_SAMPLER_REDUCTION_MODE_CREATE_INFO:
+                    hasher.add(reinterpret_cast<const VkSamplerReductionModeCreateInfo*>(p_struct)->reductionMode);
+                    break;
+                case VK_STRUCTURE_TYPE_IMAGE_VIEW_USAGE_CREATE_INFO:
+                    hasher.add(reinterpret_cast<const VkImageViewUsageCreateInfo*>(p_struct)->usage);
+                    break;
+                case VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO:
+                {
+                    const auto* p_binding_flags = reinterpret_cast<const VkDescriptorSetLayoutBindingFlagsCreateInfo*>(p_struct);
+                    hasher.add(p_binding_flags->bindingCount);
+                    hasher.add(p_binding_flags->pBindingFlags, p_binding_flags->bindingCount * sizeof(VkDescriptorBindingFlags));
+                    break;
+                }
+                default:
+                    std::cerr << "Cannot cache objects created with pNext sType " << p_struct->sType << "!\n";
+                    exit(EXIT_FAILURE);
+            }
+        }
+    }
+
+    uint64_t hash_create_info(const VkSamplerCreateInfo& create_info)
+    {
+        Hasher hasher;
+        add_pnext_chain(hasher, create_info.pNext);
+        hasher.add(create_info.flags);
+        hasher.add(create_info.magFilter);
+        hasher.add(create_info.minFilter);
+        hasher.add(create_info.mipmapMode);
+        hasher.add(create_info.addressModeU);
+        hasher.add(create_info.addressModeV);
+        hasher.add(create_info.addressModeW);
+        hasher.add(create_info.mipLodBias);
+        hasher.add(create_info.anisotropyEnable);
+        hasher.add(create_info.maxAnisotropy);
+        hasher.add(create_info.compareEnable);
+        hasher.add(create_info.compareOp);
+        hasher.add(create_info.minLod);
+        hasher.add(create_info.maxLod);
+        hasher.add(create_info.borderColor);
+        hasher.add(create_info.unnormalizedCoordinates);
+        return hasher.value;
+    }
+
+    uint64_t hash_create_info(const VkImageViewCreateInfo& create_info)
+    {
+        Hasher hasher;
+        add_pnext_chain(hasher, create_info.pNext);
+        hasher.add(create_info.flags);
+        hasher.add(create_info.image);
+        hasher.add(create_info.viewType);
+        hasher.add(create_info.format);
+        hasher.add(create_info.components);
+        hasher.add(create_info.subresourceRange);
+        return hasher.value;
+    }
+
+    uint64_t hash_create_info(const VkDescriptorSetLayoutCreateInfo& create_info)
+    {
+        Hasher hasher;
+        add_pnext_chain(hasher, create_info.pNext);
+        hasher.add(create_info.flags);
+        hasher.add(create_info.bindingCount);
+
+        for (uint32_t i = 0; i < create_info.bindingCount; i++)
+        {
+            const VkDescriptorSetLayoutBinding& binding = create_info.pBindings[i];
+            hasher.add(binding.binding);
+            hasher.add(binding.descriptorType);
+            hasher.add(binding.descriptorCount);
+            hasher.add(binding.stageFlags);
+
+            // Immutable samplers are part of the layout, the handles are (cached samplers make them match).
+            if (binding.pImmutableSamplers != nullptr)
+                hasher.add(binding.pImmutableSamplers, binding.descriptorCount * sizeof(VkSampler));
+        }
+
+        return hasher.value;
+    }
+};
+
+VkSampler object_cache::acquire_sampler(const VkSamplerCreateInfo& create_info)
+{
+    const uint64_t hash = hash_create_info(create_info);
+
+    std::lock_guard lock(cache_mutex);
+
+    if (!sampler_map.entry_map.contains(hash))
+    {
+        const uint32_t max_sampler_count = vk_core::get_physical_device_properties().limits.maxSamplerAllocationCount;
+
+        // Unreferenced samplers still count against the limit.
+        if (sampler_map.entry_map.size() >= max_sampler_count)
+            trim_locked();
+
+        if (sampler_map.entry_map.size() >= max_sampler_count)
+        {
+            std::cerr << "All " << max_sampler_count << " samplers the device allows are referenced!\n";
+            exit(EXIT_FAILURE);
+        }
+
+        sampler_map.insert(hash, vk_core::create_sampler(create_info));
+    }
+
+    return sampler_map.reference(hash);
+}
+
+void object_cache::release_sampler(VkSampler vk_handle_sampler, uint64_t timeline_value)
+{
+    // Only unreferenced samplers are trimmed, the reference has to outlive the frames using it.
+    vk_core::defer_destruction(timeline_value, [vk_handle_sampler]() {
+        std::lock_guard lock(cache_mutex);
+        sampler_map.unreference(vk_handle_sampler, "Sampler");
+    });
+}
+
+VkImageView object_cache::acquire_image_view(const VkImageViewCreateInfo& create_info)
+{
+    const uint64_t hash = hash_create_info(create_info);
+
+    std::lock_guard lock(cache_mutex);
+
+    if (!image_view_map.entry_map.contains(hash))
+        image_view_map.insert(hash, vk_core::create_image_view(create_info));
+
+    return image_view_map.reference(hash);
+}
+
+void object_cache::release_image_view(VkImageView vk_handle_image_view, uint64_t timeline_value)
+{
+    std::lock_guard lock(cache_mutex);
+
+    const ObjectEntry<VkImageView>* entry = image_view_map.unreference(vk_handle_image_view, "Image view");
+
+    if (entry == nullptr || entry->ref_count > 0u)
+        return;
+
+    // Forgotten right away, the image may be destroyed and its handle reused before the view is.
+    image_view_map.entry_map.erase(image_view_map.hash_map.at(vk_handle_image_view));
+    image_view_map.hash_map.erase(vk_handle_image_view);
+
+    vk_core::defer_destruction(timeline_value, [vk_handle_image_view]() { vk_core::destroy_image_view(vk_handle_image_view); });
+}
+
+VkDescriptorSetLayout object_cache::acquire_desc_set_layout(const VkDescriptorSetLayoutCreateInfo& create_info)
+{
+    const uint64_t hash = hash_create_info(create_info);
+
+    std::lock_guard lock(cache_mutex);
+
+    if (!desc_set_layout_map.entry_map.contains(hash))
+        desc_set_layout_map.insert(hash, vk_core::create_desc_set_layout(create_info));
+
+    return desc_set_layout_map.reference(hash);
+}
+
+void object_cache::release_desc_set_layout(VkDescriptorSetLayout vk_handle_desc_set_layout)
+{
+    std::lock_guard lock(cache_mutex);
+    desc_set_layout_map.unreference(vk_handle_desc_set_layout, "Descriptor set layout");
+}
+
+void object_cache::trim()
+{
+    std::lock_guard lock(cache_mutex);
+    trim_locked();
+}
+
+void object_cache::destroy()
+{
+    std::lock_guard lock(cache_mutex);
+
+    sampler_map.clear("sampler", [](VkSampler vk_handle_sampler) { vk_core::destroy_sampler(vk_handle_sampler); });
+    image_view_map.clear("image view", [](VkImageView vk_handle_image_view) { vk_core::destroy_image_view(vk_handle_image_view); });
+    desc_set_layout_map.clear("descriptor set layout", [](VkDescriptorSetLayout vk_handle_desc_set_layout) { vk_core::destroy_desc_set_layout(vk_handle_desc_set_layout); });
+}
+
+uint32_t object_cache::get_sampler_count()
+{
+    std::lock_guard lock(cache_mutex);
+    return static_cast<uint32_t>(sampler_map.entry_map.size());
+}
+
+uint32_t object_cache::get_image_view_count()
+{
+    std::lock_guard lock(cache_mutex);
+    return static_cast<uint32_t>(image_view_map.entry_map.size());
+}
+
+uint32_t object_cache::get_desc_set_layout_count()
+{
+    std::lock_guard lock(cache_mutex);
+    return static_cast<uint32_t>(desc_set_layout_map.entry_map.size());
+}
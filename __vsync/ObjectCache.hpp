@@ -0,0 +1,43 @@
+#ifndef OBJECT_CACHE_HPP
+#define OBJECT_CACHE_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <inttypes.h>
+
+// Samplers, image views and descriptor set layouts keyed by a hash of their create info, identical create
+// infos share one handle. Content loading asks for the same few dozen samplers and layouts over and over,
+// and some drivers cap the number of samplers (maxSamplerAllocationCount).
+//
+// acquire_*() references an object, release_*() drops the reference. Unreferenced samplers and layouts
+// stay cached until trim() or destroy(), call trim() once a batch of content is loaded. Unreferenced image
+// views are destroyed, their image may be destroyed next. Set layouts are released without a timeline
+// value, the GPU does not read them, but sets are allocated and written with them and pipeline layouts
+// created from them, so the caller keeps its reference until it is done with those. Releases after
+// destroy() are ignored. Acquiring a sampler exits when maxSamplerAllocationCount samplers are referenced.
+//
+// pNext chains are hashed by content for VkSamplerReductionModeCreateInfo, VkImageViewUsageCreateInfo
+// and VkDescriptorSetLayoutBindingFlagsCreateInfo, other structs in the chain exit.
+namespace object_cache
+{
+    // timeline_value is the submit timeline value of the last work that may use the sampler / view, it is
+    // not destroyed before the timeline passes it.
+    VkSampler acquire_sampler(const VkSamplerCreateInfo& create_info);
+    void release_sampler(VkSampler vk_handle_sampler, uint64_t timeline_value);
+
+    VkImageView acquire_image_view(const VkImageViewCreateInfo& create_info);
+    void release_image_view(VkImageView vk_handle_image_view, uint64_t timeline_value);
+
+    VkDescriptorSetLayout acquire_desc_set_layout(const VkDescriptorSetLayoutCreateInfo& create_info);
+    void release_desc_set_layout(VkDescriptorSetLayout vk_handle_desc_set_layout);
+
+    // Destroys samplers and layouts that are not referenced.
+    void trim();
+    void destroy();
+
+    uint32_t get_sampler_count();
+    uint32_t get_image_view_count();
+    uint32_t get_desc_set_layout_count();
+};
+
+#endif
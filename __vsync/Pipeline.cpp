@@ -1,7 +1,20 @@
 #include "Pipeline.hpp"
+#include "DescriptorBuffer.hpp"
+#include "Hash.hpp"
+#include "PipelineLayoutCache.hpp"
+#include "PipelineWarmup.hpp"
+#include "ShaderModuleCache.hpp"
+#include "SpirvReflection.hpp"
 #include "vk_core.hpp"
 
+#include <algorithm>
+#include <deque>
 #include <iostream>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <condition_variable>
+#include <unordered_map>
 
 namespace 
 {
@@ -13,50 +26,515 @@ namespace
             return VK_SHADER_STAGE_GEOMETRY_BIT;
         if (shader_name.ends_with(".frag"))
             return VK_SHADER_STAGE_FRAGMENT_BIT;
+        if (shader_name.ends_with(".comp"))
+            return VK_SHADER_STAGE_COMPUTE_BIT;
 
         return  VK_SHADER_STAGE_FLAG_BITS_MAX_ENUM;
     };
 
+    std::string get_file_name(const std::string& path)
+    {
+        return path.substr(path.find_last_of('/') + 1);
+    }
+
+    // e.g. "[0, 1]", empty for programs without specialization constants.
+    std::string get_variant_suffix(const VariantKey& variant_key)
+    {
+        if (variant_key.empty())
+            return "";
+
+        std::string suffix = "[";
+
+        for (size_t i = 0; i < variant_key.size(); i++)
+            suffix += ((i > 0) ? ", " : "") + std::to_string(variant_key[i]);
+
+        return suffix + "]";
+    }
+
+
+    std::mutex pipeline_library_mutex;
+    std::unordered_map<uint64_t, VkPipeline> pipeline_library_map;
+
+    VkPipeline find_pipeline_library(uint64_t key)
+    {
+        std::lock_guard lock(pipeline_library_mutex);
+
+        const auto it = pipeline_library_map.find(key);
+        return (it != pipeline_library_map.end()) ? it->second : VK_NULL_HANDLE;
+    }
+
+    // Two workers can build the same library at the same time, the first one to finish is kept.
+    VkPipeline insert_pipeline_library(uint64_t key, VkPipeline vk_handle_library)
+    {
+        std::lock_guard lock(pipeline_library_mutex);
+
+        const auto [it, inserted] = pipeline_library_map.try_emplace(key, vk_handle_library);
+
+        if (!inserted)
+            vk_core::destroy_pipeline(vk_handle_library);
+
+        return it->second;
+    }
+
+    VkPipelineLibraryCreateInfoKHR get_library_info(const std::array<VkPipeline, 4>& vk_handle_library_array)
+    {
+        return {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR,
+            .pNext = nullptr,
+            .libraryCount = static_cast<uint32_t>(vk_handle_library_array.size()),
+            .pLibraries = vk_handle_library_array.data(),
+        };
+    }
+
+    // Without LINK_TIME_OPTIMIZATION the link is only meant to be cheap, not to produce fast code.
+    VkGraphicsPipelineCreateInfo get_link_create_info(const VkPipelineLibraryCreateInfoKHR& create_info_library, VkPipelineLayout vk_handle_pipeline_layout, bool optimize)
+    {
+        return {
+            .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+            .pNext = &create_info_library,
+            .flags = (optimize ? static_cast<VkPipelineCreateFlags>(VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT) : 0x0u) | descriptor_backend::get_pipeline_create_flags(),
+            .layout = vk_handle_pipeline_layout,
+            .renderPass = VK_NULL_HANDLE,
+            .subpass = 0u,
+            .basePipelineHandle = VK_NULL_HANDLE,
+            .basePipelineIndex = 0u,
+        };
+    }
+
+    VkPipeline create_pipeline_library(VkGraphicsPipelineLibraryFlagsEXT library_flags, VkGraphicsPipelineCreateInfo create_info, const std::string& name)
+    {
+        const VkGraphicsPipelineLibraryCreateInfoEXT create_info_library {
+            .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT,
+            .pNext = const_cast<void*>(create_info.pNext),
+            .flags = library_flags,
+        };
+
+        create_info.pNext = &create_info_library;
+        create_info.flags |= VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT | descriptor_backend::get_pipeline_create_flags();
+
+        return vk_core::create_graphics_pipeline(create_info, name.c_str());
+    }
+
+    struct ProgramCacheEntry
+    {
+        std::shared_ptr<AsyncGraphicsProgram> program;
+        std::atomic<uint32_t> ref_count {0u};
+    };
+
+    // Lookups only take the lock shared, the lock is exclusive to insert and erase.
+    std::shared_mutex program_cache_mutex;
+    std::unordered_map<uint64_t, ProgramCacheEntry> program_cache_map;
+
+    std::shared_ptr<AsyncGraphicsProgram> find_program(uint64_t key)
+    {
+        std::shared_lock lock(program_cache_mutex);
+
+        const auto it = program_cache_map.find(key);
+
+        if (it == program_cache_map.end())
+            return nullptr;
+
+        it->second.ref_count.fetch_add(1u, std::memory_order_relaxed);
+        return it->second.program;
+    }
+
+    // References the program with the key, creating a pending one if there is none. The caller has to
+    // compile the program if the second value is true, everyone else shares it (and waits for it).
+    std::pair<std::shared_ptr<AsyncGraphicsProgram>, bool> acquire_program(uint64_t key)
+    {
+        if (std::shared_ptr<AsyncGraphicsProgram> program = find_program(key))
+            return {program, false};
+
+        std::lock_guard lock(program_cache_mutex);
+
+        auto [it, inserted] = program_cache_map.try_emplace(key);
+
+        if (inserted)
+            it->second.program = std::make_shared<AsyncGraphicsProgram>(key);
+
+        it->second.ref_count.fetch_add(1u, std::memory_order_relaxed);
+
+        return {it->second.program, inserted};
+    }
+
+    // True if this was the last reference, the program is no longer cached then.
+    bool release_program(uint64_t key)
+    {
+        std::lock_guard lock(program_cache_mutex);
+
+        const auto it = program_cache_map.find(key);
+
+        if (it->second.ref_count.fetch_sub(1u, std::memory_order_relaxed) > 1u)
+            return false;
+
+        program_cache_map.erase(it);
+        return true;
+    }
+
+    // Programs compiled together with one vkCreateGraphicsPipelines call.
+    struct CompileJob
+    {
+        std::vector<Compiler_GraphicsProgram> compiler_vec;
+        std::vector<std::shared_ptr<AsyncGraphicsProgram>> program_vec;
+    };
+
+    // Large enough for the driver to spread a batch over its own threads, small enough that a level load
+    // is split over all compile workers.
+    constexpr size_t max_compile_batch_size = 16u;
+
+    std::mutex compile_job_mutex;
+    std::condition_variable compile_job_cv;
+    std::deque<CompileJob> compile_job_queue;
+    std::vector<std::thread> compile_worker_vec;
+    bool stop_compile_workers = false;
+    std::atomic<uint32_t> completed_compile_count {0u};
 
-    VkShaderModule create_shader_module(const std::string& shader_name)
+    void run_compile_worker()
     {
-        const std::string filepath = shader_name + ".spv";
+        while (true)
+        {
+            CompileJob job;
+
+            {
+                std::unique_lock lock(compile_job_mutex);
+                compile_job_cv.wait(lock, [] { return stop_compile_workers || !compile_job_queue.empty(); });
+
+                if (compile_job_queue.empty())
+                    return;
+
+                job = std::move(compile_job_queue.front());
+                compile_job_queue.pop_front();
+            }
+
+            Compiler_GraphicsProgram::compile_batch_into(job.compiler_vec, job.program_vec);
+            completed_compile_count.fetch_add(static_cast<uint32_t>(job.program_vec.size()), std::memory_order_relaxed);
+        }
+    }
+
+};
+
+// Create infos of a monolithic pipeline and the state they point to. Not movable, the pointers are into the object.
+struct MonolithicPipelineState
+{
+    VkSpecializationInfo specialization_info;
+    std::vector<VkPipelineShaderStageCreateInfo> create_info_shader_stage_vec;
+    VkPipelineVertexInputStateCreateInfo create_info_vertex_input;
+    VkPipelineInputAssemblyStateCreateInfo create_info_input_assembly;
+    VkPipelineTessellationStateCreateInfo create_info_tesselation;
+    VkPipelineViewportStateCreateInfo create_info_viewport;
+    VkPipelineRasterizationStateCreateInfo create_info_rasterization;
+    VkPipelineMultisampleStateCreateInfo create_info_multisample_state;
+    VkPipelineDepthStencilStateCreateInfo create_info_depth_stencil;
+    VkPipelineColorBlendStateCreateInfo create_info_blend_state;
+    VkPipelineDynamicStateCreateInfo create_info_dynamic_state;
+    VkPipelineRenderingCreateInfo create_info_rendering;
+    VkGraphicsPipelineCreateInfo create_info_pipeline;
+
+    MonolithicPipelineState() = default;
+    MonolithicPipelineState(const MonolithicPipelineState&) = delete;
+    MonolithicPipelineState& operator=(const MonolithicPipelineState&) = delete;
+};
+
+VkPipeline AsyncGraphicsProgram::get_pipeline_or(VkPipeline vk_handle_fallback_pipeline) const
+{
+    const VkPipeline vk_handle_pipeline = is_ready() ? m_vk_handle_pipeline.load(std::memory_order_acquire) : VK_NULL_HANDLE;
+    return (vk_handle_pipeline != VK_NULL_HANDLE) ? vk_handle_pipeline : vk_handle_fallback_pipeline;
+}
+
+bool AsyncGraphicsProgram::has_failed() const
+{
+    return is_optimized() && m_vk_handle_pipeline.load(std::memory_order_acquire) == VK_NULL_HANDLE;
+}
+
+std::pair<VkPipeline, VkPipelineLayout> AsyncGraphicsProgram::wait() const
+{
+    m_state.wait(Pending, std::memory_order_acquire);
+    return {m_vk_handle_pipeline.load(std::memory_order_acquire), m_vk_handle_pipeline_layout};
+}
+
+void AsyncGraphicsProgram::fulfill(std::pair<VkPipeline, VkPipelineLayout> program, bool is_final)
+{
+    m_vk_handle_pipeline_layout = program.second;
+    m_vk_handle_pipeline.store(program.first, std::memory_order_release);
+
+    if (!is_final)
+        m_vk_handle_fast_link_pipeline = program.first;
+
+    m_state.store(is_final ? Final : Ready, std::memory_order_release);
+    m_state.notify_all();
+}
+
+void AsyncGraphicsProgram::upgrade(VkPipeline vk_handle_optimized_pipeline)
+{
+    m_vk_handle_pipeline.store(vk_handle_optimized_pipeline, std::memory_order_release);
+    m_state.store(Final, std::memory_order_release);
+    m_state.notify_all();
+}
+
+// The cache entry is erased here, the caller's reference keeps the program alive until it returns.
+void AsyncGraphicsProgram::destroy()
+{
+    if (!release_program(m_key))
+        return;
+
+    uint32_t state = m_state.load(std::memory_order_acquire);
+
+    while (state != Final)
+    {
+        m_state.wait(state, std::memory_order_acquire);
+        state = m_state.load(std::memory_order_acquire);
+    }
+
+    if (m_vk_handle_fast_link_pipeline != VK_NULL_HANDLE)
+        vk_core::destroy_pipeline(m_vk_handle_fast_link_pipeline);
+
+    vk_core::destroy_pipeline(m_vk_handle_pipeline.load(std::memory_order_acquire));
+}
+
+void pipeline_compile_workers::start(uint32_t worker_count)
+{
+    stop_compile_workers = false;
+
+    for (uint32_t i = 0; i < worker_count; i++)
+        compile_worker_vec.emplace_back(run_compile_worker);
+}
+
+void pipeline_compile_workers::stop()
+{
+    {
+        std::lock_guard lock(compile_job_mutex);
+        stop_compile_workers = true;
+    }
 
-        FILE* f = fopen(filepath.c_str(), "r");
-        if (f == 0 )
+    compile_job_cv.notify_all();
+
+    for (auto& worker : compile_worker_vec)
+        worker.join();
+
+    compile_worker_vec.clear();
+}
+
+uint32_t pipeline_compile_workers::take_completed_count()
+{
+    return completed_compile_count.exchange(0u, std::memory_order_relaxed);
+}
+
+void ShaderSpecialization::set_constants(std::vector<SpecializationConstant>&& constant_vec)
+{
+    m_constant_vec = constant_vec;
+    m_map_entry_vec.clear();
+    m_variant_key.clear();
+
+    for (const SpecializationConstant& constant : m_constant_vec)
+    {
+        if (constant.value_domain.empty())
         {
-            std::cerr << "Failed to open file " << filepath << "!\n";
+            std::cerr << "Specialization constant " << constant.name << " has no values!\n";
             exit(EXIT_FAILURE);
         }
 
-        fseek(f, 0, SEEK_END);
-        const size_t nbytes_file_size = (size_t)ftell(f);
-        rewind(f);
+        m_map_entry_vec.push_back({
+            .constantID = constant.constant_id,
+            .offset = static_cast<uint32_t>(m_variant_key.size() * sizeof(uint32_t)),
+            .size = sizeof(uint32_t),
+        });
+
+        m_variant_key.push_back(constant.value_domain.front());
+    }
+}
 
-        uint32_t* buffer = (uint32_t*)malloc(nbytes_file_size);
-        const auto size = fread(buffer, nbytes_file_size, 1, f);
-        fclose(f);
+void ShaderSpecialization::set_variant(const VariantKey& variant_key)
+{
+    bool valid = variant_key.size() == m_constant_vec.size();
 
-        const VkShaderModuleCreateInfo create_info {
-            .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
-            .codeSize = nbytes_file_size,
-            .pCode = buffer,
-        };
+    for (size_t i = 0; valid && i < variant_key.size(); i++)
+    {
+        const std::vector<uint32_t>& value_domain = m_constant_vec[i].value_domain;
+        valid = std::find(value_domain.begin(), value_domain.end(), variant_key[i]) != value_domain.end();
+    }
+
+    if (!valid)
+    {
+        std::cerr << "Variant key does not match the specialization constants!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    m_variant_key = variant_key;
+}
+
+VariantKey ShaderSpecialization::make_variant_key(const std::vector<std::pair<std::string, uint32_t>>& value_vec) const
+{
+    VariantKey variant_key;
+
+    for (const SpecializationConstant& constant : m_constant_vec)
+        variant_key.push_back(constant.value_domain.front());
+
+    for (const auto& [name, value] : value_vec)
+    {
+        const auto it = std::find_if(m_constant_vec.begin(), m_constant_vec.end(), [&name](const SpecializationConstant& constant) {
+            return constant.name == name;
+        });
+
+        if (it == m_constant_vec.end())
+        {
+            std::cerr << "Unknown specialization constant " << name << "!\n";
+            exit(EXIT_FAILURE);
+        }
+
+        variant_key[it - m_constant_vec.begin()] = value;
+    }
+
+    return variant_key;
+}
+
+const VariantKey& ShaderSpecialization::get_variant() const
+{
+    return m_variant_key;
+}
+
+std::vector<VariantKey> ShaderSpecialization::get_all_variant_keys() const
+{
+    std::vector<VariantKey> variant_key_vec = {{}};
 
-        const VkShaderModule shader_module = vk_core::create_shader_module(create_info);
+    for (const SpecializationConstant& constant : m_constant_vec)
+    {
+        std::vector<VariantKey> expanded_key_vec;
+
+        for (const VariantKey& variant_key : variant_key_vec)
+        {
+            for (const uint32_t value : constant.value_domain)
+            {
+                expanded_key_vec.push_back(variant_key);
+                expanded_key_vec.back().push_back(value);
+            }
+        }
 
-        free(buffer);
+        variant_key_vec = std::move(expanded_key_vec);
+    }
+
+    return variant_key_vec;
+}
 
-        return shader_module;
+VkSpecializationInfo ShaderSpecialization::get_info() const
+{
+    return {
+        .mapEntryCount = static_cast<uint32_t>(m_map_entry_vec.size()),
+        .pMapEntries = m_map_entry_vec.data(),
+        .dataSize = m_variant_key.size() * sizeof(uint32_t),
+        .pData = m_variant_key.data(),
     };
+}
 
-};
+void ShaderSpecialization::add_to(Hasher& hasher) const
+{
+    hasher.add(m_map_entry_vec);
+    hasher.add(m_variant_key);
+}
+
+void Compiler_GraphicsProgram::set_name(const std::string& name)
+{
+    m_name = name;
+}
+
+std::string Compiler_GraphicsProgram::get_feedback_name() const
+{
+    std::string name = m_name;
+
+    for (size_t i = 0; name.empty() && i < m_shader_path_vec.size(); i++)
+        name += ((i > 0) ? " + " : "") + get_file_name(m_shader_path_vec[i]);
+
+    return name + get_variant_suffix(m_specialization.get_variant());
+}
 
 void Compiler_GraphicsProgram::set_shaders(std::vector<std::string>&& shader_path_vec)
 {
     m_shader_path_vec = shader_path_vec;
 }
 
+void Compiler_GraphicsProgram::set_specialization_constants(std::vector<SpecializationConstant>&& constant_vec)
+{
+    m_specialization.set_constants(std::move(constant_vec));
+}
+
+void Compiler_GraphicsProgram::set_variant(const VariantKey& variant_key)
+{
+    m_specialization.set_variant(variant_key);
+}
+
+VariantKey Compiler_GraphicsProgram::make_variant_key(const std::vector<std::pair<std::string, uint32_t>>& value_vec) const
+{
+    return m_specialization.make_variant_key(value_vec);
+}
+
+const VariantKey& Compiler_GraphicsProgram::get_variant() const
+{
+    return m_specialization.get_variant();
+}
+
+std::vector<VariantKey> Compiler_GraphicsProgram::get_all_variant_keys() const
+{
+    return m_specialization.get_all_variant_keys();
+}
+
+void Compiler_GraphicsProgram::set_dynamic_state(std::vector<VkDynamicState>&& dynamic_state_vec)
+{
+    // Enum values of VK_EXT_extended_dynamic_state3 (extension number 456).
+    constexpr uint32_t extended_dynamic_state_3_first = 1000455000u;
+    constexpr uint32_t extended_dynamic_state_3_last = 1000455999u;
+
+    for (const VkDynamicState dynamic_state : dynamic_state_vec)
+    {
+        switch (dynamic_state)
+        {
+            // vk_core only enables VK_EXT_extended_dynamic_state3 together with these three features.
+            case VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT:
+            case VK_DYNAMIC_STATE_COLOR_BLEND_EQUATION_EXT:
+            case VK_DYNAMIC_STATE_COLOR_WRITE_MASK_EXT:
+                if (!vk_core::is_device_extension_enabled(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME))
+                {
+                    std::cerr << "Dynamic state " << dynamic_state << " needs VK_EXT_extended_dynamic_state3!\n";
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            default:
+                if (static_cast<uint32_t>(dynamic_state) >= extended_dynamic_state_3_first && static_cast<uint32_t>(dynamic_state) <= extended_dynamic_state_3_last)
+                {
+                    std::cerr << "Dynamic state " << dynamic_state << " needs an extendedDynamicState3 feature that is not enabled!\n";
+                    exit(EXIT_FAILURE);
+                }
+                break;
+        }
+    }
+
+    m_dynamic_state_vec = dynamic_state_vec;
+}
+
+void Compiler_GraphicsProgram::set_push_constants(VkShaderStageFlags stage_flags, uint32_t size)
+{
+    if (size == 0u || size % 4u != 0u || size > vk_core::get_physical_device_properties().limits.maxPushConstantsSize)
+    {
+        std::cerr << "Push constant size " << size << " has to be a multiple of 4 up to maxPushConstantsSize!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    m_push_constant_range = {stage_flags, 0u, size};
+}
+
+void Compiler_GraphicsProgram::set_push_descriptor_set(uint32_t set)
+{
+    m_push_desc_set = set;
+}
+
+bool Compiler_GraphicsProgram::is_dynamic_state(VkDynamicState dynamic_state) const
+{
+    return std::find(m_dynamic_state_vec.begin(), m_dynamic_state_vec.end(), dynamic_state) != m_dynamic_state_vec.end();
+}
+
+bool Compiler_GraphicsProgram::uses_shader(const std::string& shader_path) const
+{
+    return std::find(m_shader_path_vec.begin(), m_shader_path_vec.end(), shader_path) != m_shader_path_vec.end();
+}
+
 void Compiler_GraphicsProgram::set_vertex_input_bindings(std::vector<VkVertexInputBindingDescription>&& binding_desc_vec)
 {
     m_vertex_binding_desc_vec = binding_desc_vec;
@@ -113,61 +591,155 @@ void Compiler_GraphicsProgram::set_color_attachment_format(const std::vector<VkF
     m_color_attachment_format_vec = format_vec;
 }
 
-std::pair<VkPipeline, VkPipelineLayout> Compiler_GraphicsProgram::compile()
+std::vector<VkPipelineShaderStageCreateInfo> Compiler_GraphicsProgram::create_shader_stages(VkShaderStageFlags stage_mask, const VkSpecializationInfo* specialization_info) const
 {
     std::vector<VkPipelineShaderStageCreateInfo> create_info_shader_stage_vec;
 
     for (const std::string& shader_name : m_shader_path_vec)
     {
+        const VkShaderStageFlagBits stage = get_shader_stage(shader_name);
+
+        if ((stage & stage_mask) == 0x0)
+            continue;
+
         const VkPipelineShaderStageCreateInfo create_info {
             .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
             .pNext = nullptr,
             .flags = 0x0,
-            .stage = get_shader_stage(shader_name),
-            .module = create_shader_module(shader_name),
+            .stage = stage,
+            .module = shader_module_cache::acquire(shader_name + ".spv"),
             .pName = "main",
-            .pSpecializationInfo = nullptr,
+            .pSpecializationInfo = specialization_info,
         };
 
         create_info_shader_stage_vec.push_back(create_info);
     }
 
-    const VkPipelineVertexInputStateCreateInfo create_info_vertex_input {
+    return create_info_shader_stage_vec;
+}
+
+struct ReflectionCache
+{
+    std::mutex mutex;
+    std::vector<std::string> spirv_path_vec;
+    std::vector<uint64_t> content_hash_vec;
+    std::unordered_map<uint64_t, ShaderInterface> shader_interface_map;    // specialization hash -> interface
+};
+
+std::shared_ptr<ReflectionCache> Compiler_GraphicsProgram::create_reflection_cache()
+{
+    return std::make_shared<ReflectionCache>();
+}
+
+ShaderInterface Compiler_GraphicsProgram::reflect_shaders() const
+{
+    std::vector<std::string> spirv_path_vec;
+    std::vector<uint64_t> content_hash_vec;
+
+    // Content hashes come from shader_module_cache, which only rehashes a file when its mtime or size changed.
+    for (const std::string& shader_name : m_shader_path_vec)
+    {
+        spirv_path_vec.push_back(shader_name + ".spv");
+        content_hash_vec.push_back(shader_module_cache::get_content_hash(spirv_path_vec.back()));
+    }
+
+    // Array lengths may be specialization constants, the interface depends on the variant.
+    Hasher specialization_hasher;
+    m_specialization.add_to(specialization_hasher);
+
+    ShaderInterface shader_interface;
+
+    {
+        std::lock_guard lock(m_reflection_cache->mutex);
+
+        if (m_reflection_cache->spirv_path_vec != spirv_path_vec || m_reflection_cache->content_hash_vec != content_hash_vec)
+        {
+            m_reflection_cache->shader_interface_map.clear();
+            m_reflection_cache->spirv_path_vec = spirv_path_vec;
+            m_reflection_cache->content_hash_vec = content_hash_vec;
+        }
+
+        auto it = m_reflection_cache->shader_interface_map.find(specialization_hasher.value);
+
+        if (it == m_reflection_cache->shader_interface_map.end())
+        {
+            const VkSpecializationInfo specialization_info = m_specialization.get_info();
+            it = m_reflection_cache->shader_interface_map.emplace(specialization_hasher.value, spirv_reflection::reflect_program(spirv_path_vec, &specialization_info)).first;
+        }
+
+        shader_interface = it->second;
+    }
+
+    // Explicit attributes win, e.g. to interleave or split the inputs over several bindings.
+    if (!m_vertex_atrrib_desc_vec.empty())
+    {
+        shader_interface.vertex_binding_desc_vec = m_vertex_binding_desc_vec;
+        shader_interface.vertex_attrib_desc_vec = m_vertex_atrrib_desc_vec;
+    }
+
+    if (m_push_constant_range.size != 0u)
+    {
+        for (const VkPushConstantRange& range : shader_interface.push_constant_range_vec)
+        {
+            if ((range.stageFlags & ~m_push_constant_range.stageFlags) != 0x0 || range.offset + range.size > m_push_constant_range.size)
+            {
+                std::cerr << "Push constants of " << get_feedback_name() << " do not cover the shaders' push constant block!\n";
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        shader_interface.push_constant_range_vec = {m_push_constant_range};
+    }
+
+    shader_interface.push_desc_set = m_push_desc_set;
+
+    return shader_interface;
+}
+
+VkPipelineVertexInputStateCreateInfo Compiler_GraphicsProgram::get_vertex_input_state(const ShaderInterface& shader_interface) const
+{
+    return {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
         .pNext = nullptr,
         .flags = 0x0,
-        .vertexBindingDescriptionCount = static_cast<uint32_t>(m_vertex_binding_desc_vec.size()),
-        .pVertexBindingDescriptions = m_vertex_binding_desc_vec.data(),
-        .vertexAttributeDescriptionCount = static_cast<uint32_t>(m_vertex_atrrib_desc_vec.size()),
-        .pVertexAttributeDescriptions = m_vertex_atrrib_desc_vec.data(),
+        .vertexBindingDescriptionCount = static_cast<uint32_t>(shader_interface.vertex_binding_desc_vec.size()),
+        .pVertexBindingDescriptions = shader_interface.vertex_binding_desc_vec.data(),
+        .vertexAttributeDescriptionCount = static_cast<uint32_t>(shader_interface.vertex_attrib_desc_vec.size()),
+        .pVertexAttributeDescriptions = shader_interface.vertex_attrib_desc_vec.data(),
     };
+}
 
-    const VkPipelineInputAssemblyStateCreateInfo create_info_input_assembly {
+VkPipelineInputAssemblyStateCreateInfo Compiler_GraphicsProgram::get_input_assembly_state() const
+{
+    return {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
         .pNext = nullptr,
         .flags = 0x0,
         .topology = m_topology,
         .primitiveRestartEnable = VK_FALSE,
     };
+}
 
-    const VkPipelineTessellationStateCreateInfo create_info_tesselation {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO,
-        .pNext = nullptr,
-        .flags = 0x0,
-        .patchControlPoints = 0u,
-    };
+VkPipelineViewportStateCreateInfo Compiler_GraphicsProgram::get_viewport_state() const
+{
+    // The counts must be zero when they are dynamic as well.
+    const bool dynamic_viewport_count = is_dynamic_state(VK_DYNAMIC_STATE_VIEWPORT_WITH_COUNT);
+    const bool dynamic_scissor_count = is_dynamic_state(VK_DYNAMIC_STATE_SCISSOR_WITH_COUNT);
 
-    const VkPipelineViewportStateCreateInfo create_info_viewport {
+    return {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
         .pNext = nullptr,
         .flags = 0x0,
-        .viewportCount = static_cast<uint32_t>(m_viewport_vec.size()),
-        .pViewports = m_viewport_vec.data(),
-        .scissorCount = static_cast<uint32_t>(m_scissor_vec.size()),
-        .pScissors = m_scissor_vec.data(),
+        .viewportCount = dynamic_viewport_count ? 0u : static_cast<uint32_t>(m_viewport_vec.size()),
+        .pViewports = dynamic_viewport_count ? nullptr : m_viewport_vec.data(),
+        .scissorCount = dynamic_scissor_count ? 0u : static_cast<uint32_t>(m_scissor_vec.size()),
+        .pScissors = dynamic_scissor_count ? nullptr : m_scissor_vec.data(),
     };
+}
 
-    const VkPipelineRasterizationStateCreateInfo create_info_rasterization {
+VkPipelineRasterizationStateCreateInfo Compiler_GraphicsProgram::get_rasterization_state() const
+{
+    return {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
         .pNext = nullptr,
         .flags = 0x0,
@@ -182,8 +754,11 @@ std::pair<VkPipeline, VkPipelineLayout> Compiler_GraphicsProgram::compile()
         .depthBiasSlopeFactor = 0.0f,
         .lineWidth = 1.0f,
     };
+}
 
-    const VkPipelineMultisampleStateCreateInfo create_info_multisample_state {
+VkPipelineMultisampleStateCreateInfo Compiler_GraphicsProgram::get_multisample_state() const
+{
+    return {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
         .pNext = nullptr,
         .flags = 0x0,
@@ -194,8 +769,11 @@ std::pair<VkPipeline, VkPipelineLayout> Compiler_GraphicsProgram::compile()
         .alphaToCoverageEnable = VK_FALSE,
         .alphaToOneEnable = VK_FALSE,
     };
+}
 
-    const VkPipelineDepthStencilStateCreateInfo create_info_depth_stencil {
+VkPipelineDepthStencilStateCreateInfo Compiler_GraphicsProgram::get_depth_stencil_state() const
+{
+    return {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
         .pNext = nullptr,
         .flags = 0x0,
@@ -209,8 +787,11 @@ std::pair<VkPipeline, VkPipelineLayout> Compiler_GraphicsProgram::compile()
         .minDepthBounds = m_min_max_depth.first,
         .maxDepthBounds = m_min_max_depth.second,
     };
+}
 
-    const VkPipelineColorBlendStateCreateInfo create_info_blend_state {
+VkPipelineColorBlendStateCreateInfo Compiler_GraphicsProgram::get_color_blend_state() const
+{
+    return {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
         .pNext = nullptr,
         .flags = 0x0,
@@ -220,53 +801,766 @@ std::pair<VkPipeline, VkPipelineLayout> Compiler_GraphicsProgram::compile()
         .pAttachments = m_color_attachment_blend_state_vec.data(),
         .blendConstants = {0.0f, 0.0f, 0.0f, 0.0f}
     };
+}
 
-    const VkPipelineLayoutCreateInfo create_info_pipeline_layout {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+VkPipelineDynamicStateCreateInfo Compiler_GraphicsProgram::get_dynamic_state() const
+{
+    return {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
         .pNext = nullptr,
         .flags = 0x0,
-        .setLayoutCount = 0u,
-        .pSetLayouts = nullptr,
-        .pushConstantRangeCount = 0u,
-        .pPushConstantRanges = nullptr,
+        .dynamicStateCount = static_cast<uint32_t>(m_dynamic_state_vec.size()),
+        .pDynamicStates = m_dynamic_state_vec.data(),
     };
+}
+
+void Compiler_GraphicsProgram::add_pre_rasterization_state(Hasher& hasher) const
+{
+    // With a dynamic viewport / scissor only the count stays baked in, with a dynamic count nothing does.
+    if (is_dynamic_state(VK_DYNAMIC_STATE_VIEWPORT))
+        hasher.add(m_viewport_vec.size());
+    else if (!is_dynamic_state(VK_DYNAMIC_STATE_VIEWPORT_WITH_COUNT))
+        hasher.add(m_viewport_vec);
+
+    if (is_dynamic_state(VK_DYNAMIC_STATE_SCISSOR))
+        hasher.add(m_scissor_vec.size());
+    else if (!is_dynamic_state(VK_DYNAMIC_STATE_SCISSOR_WITH_COUNT))
+        hasher.add(m_scissor_vec);
+
+    hasher.add(m_polygon_mode);
+
+    if (!is_dynamic_state(VK_DYNAMIC_STATE_CULL_MODE))
+        hasher.add(m_cull_mode);
+
+    if (!is_dynamic_state(VK_DYNAMIC_STATE_FRONT_FACE))
+        hasher.add(m_front_face);
+}
+
+void Compiler_GraphicsProgram::add_fragment_shader_state(Hasher& hasher) const
+{
+    if (!is_dynamic_state(VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE))
+        hasher.add(m_depth_test_enable);
+
+    if (!is_dynamic_state(VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE))
+        hasher.add(m_depth_write_enable);
+
+    if (!is_dynamic_state(VK_DYNAMIC_STATE_DEPTH_COMPARE_OP))
+        hasher.add(m_depth_compare_op);
+
+    hasher.add(m_min_max_depth);
+    hasher.add(m_sample_count);
+}
+
+void Compiler_GraphicsProgram::add_fragment_output_state(Hasher& hasher) const
+{
+    const bool dynamic_blend_enable = is_dynamic_state(VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT);
+    const bool dynamic_blend_equation = is_dynamic_state(VK_DYNAMIC_STATE_COLOR_BLEND_EQUATION_EXT);
+    const bool dynamic_write_mask = is_dynamic_state(VK_DYNAMIC_STATE_COLOR_WRITE_MASK_EXT);
+
+    hasher.add(m_color_attachment_blend_state_vec.size());
+
+    for (const VkPipelineColorBlendAttachmentState& blend_state : m_color_attachment_blend_state_vec)
+    {
+        if (!dynamic_blend_enable)
+            hasher.add(blend_state.blendEnable);
+
+        if (!dynamic_blend_equation)
+        {
+            hasher.add(blend_state.srcColorBlendFactor);
+            hasher.add(blend_state.dstColorBlendFactor);
+            hasher.add(blend_state.colorBlendOp);
+            hasher.add(blend_state.srcAlphaBlendFactor);
+            hasher.add(blend_state.dstAlphaBlendFactor);
+            hasher.add(blend_state.alphaBlendOp);
+        }
+
+        if (!dynamic_write_mask)
+            hasher.add(blend_state.colorWriteMask);
+    }
 
-    const VkPipelineLayout vk_handle_pipeline_layout = vk_core::create_pipeline_layout(create_info_pipeline_layout);
+    hasher.add(m_color_attachment_format_vec);
+    hasher.add(m_sample_count);
+}
 
-    const VkPipelineRenderingCreateInfo create_info_rendering {
+VkPipelineRenderingCreateInfo Compiler_GraphicsProgram::get_rendering_info() const
+{
+    return {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR,
         .colorAttachmentCount = static_cast<uint32_t>(m_color_attachment_format_vec.size()),
         .pColorAttachmentFormats = m_color_attachment_format_vec.data(),
     };
+}
 
-    const VkGraphicsPipelineCreateInfo create_info_pipeline {
-        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
-        .pNext = &create_info_rendering,
+void Compiler_GraphicsProgram::fill_monolithic_state(MonolithicPipelineState& state, const ShaderInterface& shader_interface, VkPipelineLayout vk_handle_pipeline_layout) const
+{
+    state.specialization_info = m_specialization.get_info();
+    state.create_info_shader_stage_vec = create_shader_stages(VK_SHADER_STAGE_ALL_GRAPHICS, &state.specialization_info);
+
+    state.create_info_vertex_input = get_vertex_input_state(shader_interface);
+    state.create_info_input_assembly = get_input_assembly_state();
+
+    state.create_info_tesselation = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO,
+        .pNext = nullptr,
         .flags = 0x0,
-        .stageCount = static_cast<uint32_t>(create_info_shader_stage_vec.size()),
-        .pStages = create_info_shader_stage_vec.data(),
-        .pVertexInputState = &create_info_vertex_input,
-        .pInputAssemblyState = &create_info_input_assembly,
-        .pTessellationState = &create_info_tesselation,
-        .pViewportState = &create_info_viewport,
-        .pRasterizationState = &create_info_rasterization,
-        .pMultisampleState = &create_info_multisample_state,
-        .pDepthStencilState = &create_info_depth_stencil,
-        .pColorBlendState = &create_info_blend_state,
-        .pDynamicState = nullptr,
+        .patchControlPoints = 0u,
+    };
+
+    state.create_info_viewport = get_viewport_state();
+    state.create_info_rasterization = get_rasterization_state();
+    state.create_info_multisample_state = get_multisample_state();
+    state.create_info_depth_stencil = get_depth_stencil_state();
+    state.create_info_blend_state = get_color_blend_state();
+    state.create_info_dynamic_state = get_dynamic_state();
+    state.create_info_rendering = get_rendering_info();
+
+    state.create_info_pipeline = {
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+        .pNext = &state.create_info_rendering,
+        .flags = descriptor_backend::get_pipeline_create_flags(),
+        .stageCount = static_cast<uint32_t>(state.create_info_shader_stage_vec.size()),
+        .pStages = state.create_info_shader_stage_vec.data(),
+        .pVertexInputState = &state.create_info_vertex_input,
+        .pInputAssemblyState = &state.create_info_input_assembly,
+        .pTessellationState = &state.create_info_tesselation,
+        .pViewportState = &state.create_info_viewport,
+        .pRasterizationState = &state.create_info_rasterization,
+        .pMultisampleState = &state.create_info_multisample_state,
+        .pDepthStencilState = &state.create_info_depth_stencil,
+        .pColorBlendState = &state.create_info_blend_state,
+        .pDynamicState = &state.create_info_dynamic_state,
         .layout = vk_handle_pipeline_layout,
         .renderPass = VK_NULL_HANDLE,
         .subpass = 0u,
         .basePipelineHandle = VK_NULL_HANDLE,
         .basePipelineIndex = 0u,
     };
+}
 
-    const VkPipeline vk_handle_pipeline = vk_core::create_graphics_pipeline(create_info_pipeline); 
+std::pair<VkPipeline, VkPipelineLayout> Compiler_GraphicsProgram::compile_monolithic(const ShaderInterface& shader_interface, VkPipelineLayout vk_handle_pipeline_layout) const
+{
+    MonolithicPipelineState state;
+    fill_monolithic_state(state, shader_interface, vk_handle_pipeline_layout);
+
+    const VkPipeline vk_handle_pipeline = vk_core::create_graphics_pipeline(state.create_info_pipeline, get_feedback_name().c_str());
 
-    for (const auto& info : create_info_shader_stage_vec)
+    for (const auto& info : state.create_info_shader_stage_vec)
     {
-        vk_core::destroy_shader_module(info.module);
+        shader_module_cache::release(info.module);
     }
 
     return {vk_handle_pipeline, vk_handle_pipeline_layout};
 }
+
+// Layouts come deduplicated from pipeline_layout_cache, so the handle identifies the layout in the library keys.
+std::array<uint64_t, 4> Compiler_GraphicsProgram::get_library_keys(const ShaderInterface& shader_interface) const
+{
+    const uint64_t layout_key = pipeline_layout_cache::get_layout_key(shader_interface);
+
+    constexpr VkShaderStageFlags pre_rasterization_stages = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_GEOMETRY_BIT;
+
+    // Vertex Input Interface
+    Hasher vertex_input_hasher;
+    vertex_input_hasher.add(VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT);
+    vertex_input_hasher.add(shader_interface.vertex_binding_desc_vec);
+    vertex_input_hasher.add(shader_interface.vertex_attrib_desc_vec);
+    vertex_input_hasher.add(m_dynamic_state_vec);
+    // Kept with dynamic topology, the pipeline still fixes the topology class.
+    vertex_input_hasher.add(m_topology);
+
+    // Pre-Rasterization Shaders
+    Hasher pre_rasterization_hasher;
+    pre_rasterization_hasher.add(VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT);
+    for (const std::string& shader_name : m_shader_path_vec)
+    {
+        if (get_shader_stage(shader_name) & pre_rasterization_stages)
+            pre_rasterization_hasher.add(shader_module_cache::get_content_hash(shader_name + ".spv"));
+    }
+    m_specialization.add_to(pre_rasterization_hasher);
+    pre_rasterization_hasher.add(layout_key);
+    pre_rasterization_hasher.add(m_dynamic_state_vec);
+    add_pre_rasterization_state(pre_rasterization_hasher);
+
+    // Fragment Shader
+    Hasher fragment_shader_hasher;
+    fragment_shader_hasher.add(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT);
+    for (const std::string& shader_name : m_shader_path_vec)
+    {
+        if (get_shader_stage(shader_name) == VK_SHADER_STAGE_FRAGMENT_BIT)
+            fragment_shader_hasher.add(shader_module_cache::get_content_hash(shader_name + ".spv"));
+    }
+    m_specialization.add_to(fragment_shader_hasher);
+    fragment_shader_hasher.add(layout_key);
+    fragment_shader_hasher.add(m_dynamic_state_vec);
+    add_fragment_shader_state(fragment_shader_hasher);
+
+    // Fragment Output Interface
+    Hasher fragment_output_hasher;
+    fragment_output_hasher.add(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT);
+    fragment_output_hasher.add(m_dynamic_state_vec);
+    add_fragment_output_state(fragment_output_hasher);
+
+    return {
+        vertex_input_hasher.value,
+        pre_rasterization_hasher.value,
+        fragment_shader_hasher.value,
+        fragment_output_hasher.value,
+    };
+}
+
+std::array<VkPipeline, 4> Compiler_GraphicsProgram::get_pipeline_libraries(const ShaderInterface& shader_interface, VkPipelineLayout vk_handle_pipeline_layout, const std::array<uint64_t, 4>& library_key_array) const
+{
+    constexpr VkShaderStageFlags pre_rasterization_stages = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_GEOMETRY_BIT;
+
+    const VkPipelineRenderingCreateInfo create_info_rendering = get_rendering_info();
+    const VkPipelineMultisampleStateCreateInfo create_info_multisample_state = get_multisample_state();
+    const VkSpecializationInfo specialization_info = m_specialization.get_info();
+    const VkPipelineDynamicStateCreateInfo create_info_dynamic_state = get_dynamic_state();
+
+    // Vertex Input Interface
+    VkPipeline vk_handle_vertex_input_library = find_pipeline_library(library_key_array[0]);
+
+    if (vk_handle_vertex_input_library == VK_NULL_HANDLE)
+    {
+        const VkPipelineVertexInputStateCreateInfo create_info_vertex_input = get_vertex_input_state(shader_interface);
+        const VkPipelineInputAssemblyStateCreateInfo create_info_input_assembly = get_input_assembly_state();
+
+        const VkGraphicsPipelineCreateInfo create_info {
+            .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0x0,
+            .pVertexInputState = &create_info_vertex_input,
+            .pInputAssemblyState = &create_info_input_assembly,
+            .pDynamicState = &create_info_dynamic_state,
+        };
+
+        vk_handle_vertex_input_library = insert_pipeline_library(library_key_array[0],
+            create_pipeline_library(VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT, create_info, get_feedback_name() + " - Vertex Input Interface"));
+    }
+
+    // Pre-Rasterization Shaders
+    VkPipeline vk_handle_pre_rasterization_library = find_pipeline_library(library_key_array[1]);
+
+    if (vk_handle_pre_rasterization_library == VK_NULL_HANDLE)
+    {
+        const std::vector<VkPipelineShaderStageCreateInfo> create_info_shader_stage_vec = create_shader_stages(pre_rasterization_stages, &specialization_info);
+        const VkPipelineViewportStateCreateInfo create_info_viewport = get_viewport_state();
+        const VkPipelineRasterizationStateCreateInfo create_info_rasterization = get_rasterization_state();
+
+        const VkGraphicsPipelineCreateInfo create_info {
+            .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+            .pNext = &create_info_rendering,
+            .flags = 0x0,
+            .stageCount = static_cast<uint32_t>(create_info_shader_stage_vec.size()),
+            .pStages = create_info_shader_stage_vec.data(),
+            .pViewportState = &create_info_viewport,
+            .pRasterizationState = &create_info_rasterization,
+            .pDynamicState = &create_info_dynamic_state,
+            .layout = vk_handle_pipeline_layout,
+        };
+
+        vk_handle_pre_rasterization_library = insert_pipeline_library(library_key_array[1],
+            create_pipeline_library(VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT, create_info, get_feedback_name() + " - Pre-Rasterization Shaders"));
+
+        for (const auto& info : create_info_shader_stage_vec)
+            shader_module_cache::release(info.module);
+    }
+
+    // Fragment Shader
+    VkPipeline vk_handle_fragment_shader_library = find_pipeline_library(library_key_array[2]);
+
+    if (vk_handle_fragment_shader_library == VK_NULL_HANDLE)
+    {
+        const std::vector<VkPipelineShaderStageCreateInfo> create_info_shader_stage_vec = create_shader_stages(VK_SHADER_STAGE_FRAGMENT_BIT, &specialization_info);
+        const VkPipelineDepthStencilStateCreateInfo create_info_depth_stencil = get_depth_stencil_state();
+
+        const VkGraphicsPipelineCreateInfo create_info {
+            .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+            .pNext = &create_info_rendering,
+            .flags = 0x0,
+            .stageCount = static_cast<uint32_t>(create_info_shader_stage_vec.size()),
+            .pStages = create_info_shader_stage_vec.data(),
+            .pMultisampleState = &create_info_multisample_state,
+            .pDepthStencilState = &create_info_depth_stencil,
+            .pDynamicState = &create_info_dynamic_state,
+            .layout = vk_handle_pipeline_layout,
+        };
+
+        vk_handle_fragment_shader_library = insert_pipeline_library(library_key_array[2],
+            create_pipeline_library(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT, create_info, get_feedback_name() + " - Fragment Shader"));
+
+        for (const auto& info : create_info_shader_stage_vec)
+            shader_module_cache::release(info.module);
+    }
+
+    // Fragment Output Interface
+    VkPipeline vk_handle_fragment_output_library = find_pipeline_library(library_key_array[3]);
+
+    if (vk_handle_fragment_output_library == VK_NULL_HANDLE)
+    {
+        const VkPipelineColorBlendStateCreateInfo create_info_blend_state = get_color_blend_state();
+
+        const VkGraphicsPipelineCreateInfo create_info {
+            .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+            .pNext = &create_info_rendering,
+            .flags = 0x0,
+            .pMultisampleState = &create_info_multisample_state,
+            .pColorBlendState = &create_info_blend_state,
+            .pDynamicState = &create_info_dynamic_state,
+        };
+
+        vk_handle_fragment_output_library = insert_pipeline_library(library_key_array[3],
+            create_pipeline_library(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT, create_info, get_feedback_name() + " - Fragment Output Interface"));
+    }
+
+    return {
+        vk_handle_vertex_input_library,
+        vk_handle_pre_rasterization_library,
+        vk_handle_fragment_shader_library,
+        vk_handle_fragment_output_library,
+    };
+}
+
+VkPipeline Compiler_GraphicsProgram::link_pipeline_libraries(const std::array<VkPipeline, 4>& vk_handle_library_array, VkPipelineLayout vk_handle_pipeline_layout, bool optimize) const
+{
+    const VkPipelineLibraryCreateInfoKHR create_info_library = get_library_info(vk_handle_library_array);
+    const std::string name = get_feedback_name() + (optimize ? " - Optimized Link" : " - Fast Link");
+
+    return vk_core::create_graphics_pipeline(get_link_create_info(create_info_library, vk_handle_pipeline_layout, optimize), name.c_str());
+}
+
+uint64_t Compiler_GraphicsProgram::get_program_key() const
+{
+    // The library keys cover all the state, whether or not the program is linked from libraries.
+    Hasher hasher;
+    hasher.add(get_library_keys(reflect_shaders()));
+
+    return hasher.value;
+}
+
+std::shared_ptr<AsyncGraphicsProgram> Compiler_GraphicsProgram::compile() const
+{
+    const uint64_t program_key = get_program_key();
+    pipeline_warmup::record(program_key);
+
+    const auto [program, is_new] = acquire_program(program_key);
+
+    if (!is_new)
+    {
+        program->wait();
+        return program;
+    }
+
+    compile_into(*program, false);
+    completed_compile_count.fetch_add(1u, std::memory_order_relaxed);
+
+    return program;
+}
+
+void Compiler_GraphicsProgram::compile_into(AsyncGraphicsProgram& program, bool fast_link) const
+{
+    const ShaderInterface shader_interface = reflect_shaders();
+    const VkPipelineLayout vk_handle_pipeline_layout = pipeline_layout_cache::get_pipeline_layout(shader_interface);
+
+    if (!uses_pipeline_libraries())
+    {
+        program.fulfill(compile_monolithic(shader_interface, vk_handle_pipeline_layout));
+        return;
+    }
+
+    const std::array<VkPipeline, 4> vk_handle_library_array = get_pipeline_libraries(shader_interface, vk_handle_pipeline_layout,
+        get_library_keys(shader_interface));
+
+    if (!fast_link)
+    {
+        program.fulfill({link_pipeline_libraries(vk_handle_library_array, vk_handle_pipeline_layout, true), vk_handle_pipeline_layout});
+        return;
+    }
+
+    program.fulfill({link_pipeline_libraries(vk_handle_library_array, vk_handle_pipeline_layout, false), vk_handle_pipeline_layout}, false);
+    program.upgrade(link_pipeline_libraries(vk_handle_library_array, vk_handle_pipeline_layout, true));
+}
+
+std::shared_ptr<AsyncGraphicsProgram> Compiler_GraphicsProgram::compile_async() const
+{
+    const uint64_t program_key = get_program_key();
+    pipeline_warmup::record(program_key);
+
+    const auto [program, is_new] = acquire_program(program_key);
+
+    // Already compiled or queued by an earlier request for the same state.
+    if (!is_new)
+        return program;
+
+    if (compile_worker_vec.empty())
+    {
+        compile_into(*program);
+        completed_compile_count.fetch_add(1u, std::memory_order_relaxed);
+        return program;
+    }
+
+    {
+        std::lock_guard lock(compile_job_mutex);
+        compile_job_queue.push_back({{*this}, {program}});
+    }
+
+    compile_job_cv.notify_one();
+
+    return program;
+}
+
+std::vector<std::shared_ptr<AsyncGraphicsProgram>> Compiler_GraphicsProgram::compile_batch_async(const std::vector<Compiler_GraphicsProgram>& compiler_vec)
+{
+    std::vector<std::shared_ptr<AsyncGraphicsProgram>> program_vec;
+    std::vector<CompileJob> job_vec;
+
+    // Spread over the workers, but never fewer than one program per call.
+    const size_t worker_count = std::max<size_t>(compile_worker_vec.size(), 1u);
+    const size_t batch_size = std::clamp<size_t>((compiler_vec.size() + worker_count - 1u) / worker_count, 1u, max_compile_batch_size);
+
+    for (const Compiler_GraphicsProgram& compiler : compiler_vec)
+    {
+        const uint64_t program_key = compiler.get_program_key();
+        pipeline_warmup::record(program_key);
+
+        const auto [program, is_new] = acquire_program(program_key);
+        program_vec.push_back(program);
+
+        if (!is_new)
+            continue;
+
+        if (job_vec.empty() || job_vec.back().program_vec.size() == batch_size)
+            job_vec.emplace_back();
+
+        job_vec.back().compiler_vec.push_back(compiler);
+        job_vec.back().program_vec.push_back(program);
+    }
+
+    if (compile_worker_vec.empty())
+    {
+        for (const CompileJob& job : job_vec)
+        {
+            compile_batch_into(job.compiler_vec, job.program_vec);
+            completed_compile_count.fetch_add(static_cast<uint32_t>(job.program_vec.size()), std::memory_order_relaxed);
+        }
+
+        return program_vec;
+    }
+
+    {
+        std::lock_guard lock(compile_job_mutex);
+
+        for (CompileJob& job : job_vec)
+            compile_job_queue.push_back(std::move(job));
+    }
+
+    compile_job_cv.notify_all();
+
+    return program_vec;
+}
+
+void Compiler_GraphicsProgram::compile_batch_into(const std::vector<Compiler_GraphicsProgram>& compiler_vec, const std::vector<std::shared_ptr<AsyncGraphicsProgram>>& program_vec)
+{
+    // A single program keeps the fast link, a batch is for loading and goes straight to the optimized pipelines.
+    if (compiler_vec.size() == 1u)
+    {
+        compiler_vec.front().compile_into(*program_vec.front());
+        return;
+    }
+
+    const size_t program_count = compiler_vec.size();
+    const bool pipeline_libraries = uses_pipeline_libraries();
+
+    // Reserved up front, the create infos point into these.
+    std::vector<ShaderInterface> shader_interface_vec;
+    std::vector<VkPipelineLayout> vk_handle_pipeline_layout_vec;
+    std::vector<std::array<VkPipeline, 4>> vk_handle_library_array_vec;
+    std::vector<VkPipelineLibraryCreateInfoKHR> create_info_library_vec;
+    std::deque<MonolithicPipelineState> monolithic_state_deque;
+    std::vector<VkGraphicsPipelineCreateInfo> create_info_pipeline_vec;
+
+    shader_interface_vec.reserve(program_count);
+    vk_handle_library_array_vec.reserve(program_count);
+    create_info_library_vec.reserve(program_count);
+
+    for (const Compiler_GraphicsProgram& compiler : compiler_vec)
+    {
+        const ShaderInterface& shader_interface = shader_interface_vec.emplace_back(compiler.reflect_shaders());
+        const VkPipelineLayout vk_handle_pipeline_layout = vk_handle_pipeline_layout_vec.emplace_back(pipeline_layout_cache::get_pipeline_layout(shader_interface));
+
+        if (pipeline_libraries)
+        {
+            const std::array<VkPipeline, 4>& vk_handle_library_array = vk_handle_library_array_vec.emplace_back(compiler.get_pipeline_libraries(
+                shader_interface, vk_handle_pipeline_layout, compiler.get_library_keys(shader_interface)));
+
+            const VkPipelineLibraryCreateInfoKHR& create_info_library = create_info_library_vec.emplace_back(get_library_info(vk_handle_library_array));
+            create_info_pipeline_vec.push_back(get_link_create_info(create_info_library, vk_handle_pipeline_layout, true));
+        }
+        else
+        {
+            MonolithicPipelineState& state = monolithic_state_deque.emplace_back();
+            compiler.fill_monolithic_state(state, shader_interface, vk_handle_pipeline_layout);
+            create_info_pipeline_vec.push_back(state.create_info_pipeline);
+        }
+    }
+
+    std::vector<std::string> name_vec;
+    std::vector<const char*> name_ptr_vec;
+
+    for (const Compiler_GraphicsProgram& compiler : compiler_vec)
+        name_vec.push_back(compiler.get_feedback_name() + (pipeline_libraries ? " - Optimized Link" : ""));
+
+    for (const std::string& name : name_vec)
+        name_ptr_vec.push_back(name.c_str());
+
+    std::vector<VkPipeline> vk_handle_pipeline_vec(program_count, VK_NULL_HANDLE);
+    const VkResult result = vk_core::create_graphics_pipelines(static_cast<uint32_t>(program_count), create_info_pipeline_vec.data(), vk_handle_pipeline_vec.data(), name_ptr_vec.data());
+
+    for (const MonolithicPipelineState& state : monolithic_state_deque)
+    {
+        for (const auto& info : state.create_info_shader_stage_vec)
+            shader_module_cache::release(info.module);
+    }
+
+    // Failed programs are fulfilled without a pipeline so nobody waits on them forever.
+    for (size_t i = 0; i < program_count; i++)
+    {
+        if (vk_handle_pipeline_vec[i] == VK_NULL_HANDLE)
+        {
+            std::cerr << "Failed to compile program " << name_vec[i] << " (VkResult " << result << ")!\n";
+        }
+
+        program_vec[i]->fulfill({vk_handle_pipeline_vec[i], vk_handle_pipeline_layout_vec[i]});
+    }
+}
+
+bool Compiler_GraphicsProgram::uses_pipeline_libraries()
+{
+    return vk_core::is_device_extension_enabled(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+}
+
+// Linked pipelines do not reference their libraries, the cache can be destroyed while they are alive.
+void Compiler_GraphicsProgram::destroy_pipeline_library_cache()
+{
+    std::lock_guard lock(pipeline_library_mutex);
+
+    for (const auto& [key, vk_handle_library] : pipeline_library_map)
+        vk_core::destroy_pipeline(vk_handle_library);
+
+    pipeline_library_map.clear();
+}
+
+std::array<uint32_t, 3> ComputeProgram::get_group_count(const std::array<uint32_t, 3>& problem_size) const
+{
+    return {
+        (problem_size[0] + workgroup_size[0] - 1u) / workgroup_size[0],
+        (problem_size[1] + workgroup_size[1] - 1u) / workgroup_size[1],
+        (problem_size[2] + workgroup_size[2] - 1u) / workgroup_size[2],
+    };
+}
+
+VkDispatchIndirectCommand ComputeProgram::get_dispatch_indirect_command(const std::array<uint32_t, 3>& problem_size) const
+{
+    const std::array<uint32_t, 3> group_count = get_group_count(problem_size);
+
+    return {
+        .x = group_count[0],
+        .y = group_count[1],
+        .z = group_count[2],
+    };
+}
+
+void ComputeProgram::dispatch(VkCommandBuffer vk_handle_cmd_buff, const std::array<uint32_t, 3>& problem_size) const
+{
+    const std::array<uint32_t, 3> group_count = get_group_count(problem_size);
+
+    vkCmdBindPipeline(vk_handle_cmd_buff, VK_PIPELINE_BIND_POINT_COMPUTE, vk_handle_pipeline);
+    vkCmdDispatch(vk_handle_cmd_buff, group_count[0], group_count[1], group_count[2]);
+}
+
+void ComputeProgram::dispatch_indirect(VkCommandBuffer vk_handle_cmd_buff, VkBuffer vk_handle_indirect_buffer, VkDeviceSize offset) const
+{
+    vkCmdBindPipeline(vk_handle_cmd_buff, VK_PIPELINE_BIND_POINT_COMPUTE, vk_handle_pipeline);
+    vkCmdDispatchIndirect(vk_handle_cmd_buff, vk_handle_indirect_buffer, offset);
+}
+
+void ComputeProgram::destroy()
+{
+    vk_core::destroy_pipeline(vk_handle_pipeline);
+}
+
+void Compiler_ComputeProgram::set_name(const std::string& name)
+{
+    m_name = name;
+}
+
+std::string Compiler_ComputeProgram::get_feedback_name() const
+{
+    return (m_name.empty() ? get_file_name(m_shader_path) : m_name) + get_variant_suffix(m_specialization.get_variant());
+}
+
+void Compiler_ComputeProgram::set_shader(const std::string& shader_path)
+{
+    m_shader_path = shader_path;
+}
+
+static void validate_workgroup_size(const std::array<uint32_t, 3>& workgroup_size, const std::string& shader_path)
+{
+    const VkPhysicalDeviceLimits& limits = vk_core::get_physical_device_properties().limits;
+
+    const bool valid = workgroup_size[0] != 0u && workgroup_size[1] != 0u && workgroup_size[2] != 0u &&
+        workgroup_size[0] <= limits.maxComputeWorkGroupSize[0] &&
+        workgroup_size[1] <= limits.maxComputeWorkGroupSize[1] &&
+        workgroup_size[2] <= limits.maxComputeWorkGroupSize[2] &&
+        static_cast<uint64_t>(workgroup_size[0]) * workgroup_size[1] * workgroup_size[2] <= limits.maxComputeWorkGroupInvocations;
+
+    if (!valid)
+    {
+        std::cerr << "Workgroup size " << workgroup_size[0] << "x" << workgroup_size[1] << "x" << workgroup_size[2] << " of " << shader_path
+                  << " has to be non-zero within maxComputeWorkGroupSize and maxComputeWorkGroupInvocations!\n";
+        exit(EXIT_FAILURE);
+    }
+}
+
+void Compiler_ComputeProgram::set_workgroup_size(const std::array<uint32_t, 3>& workgroup_size)
+{
+    validate_workgroup_size(workgroup_size, m_shader_path);
+    m_workgroup_size = workgroup_size;
+}
+
+void Compiler_ComputeProgram::set_required_subgroup_size(uint32_t subgroup_size)
+{
+    m_required_subgroup_size = subgroup_size;
+}
+
+void Compiler_ComputeProgram::set_require_full_subgroups(bool require_full_subgroups)
+{
+    m_require_full_subgroups = require_full_subgroups;
+}
+
+void Compiler_ComputeProgram::set_specialization_constants(std::vector<SpecializationConstant>&& constant_vec)
+{
+    m_specialization.set_constants(std::move(constant_vec));
+}
+
+void Compiler_ComputeProgram::set_variant(const VariantKey& variant_key)
+{
+    m_specialization.set_variant(variant_key);
+}
+
+VariantKey Compiler_ComputeProgram::make_variant_key(const std::vector<std::pair<std::string, uint32_t>>& value_vec) const
+{
+    return m_specialization.make_variant_key(value_vec);
+}
+
+const VariantKey& Compiler_ComputeProgram::get_variant() const
+{
+    return m_specialization.get_variant();
+}
+
+std::vector<VariantKey> Compiler_ComputeProgram::get_all_variant_keys() const
+{
+    return m_specialization.get_all_variant_keys();
+}
+
+bool Compiler_ComputeProgram::use_required_subgroup_size() const
+{
+    if (m_required_subgroup_size == 0u)
+        return false;
+
+    const VkPhysicalDeviceSubgroupSizeControlProperties& properties = vk_core::get_physical_device_subgroup_size_control_properties();
+
+    const bool supported = vk_core::get_enabled_subgroup_size_control_features().subgroupSizeControl == VK_TRUE &&
+        (properties.requiredSubgroupSizeStages & VK_SHADER_STAGE_COMPUTE_BIT) &&
+        m_required_subgroup_size >= properties.minSubgroupSize &&
+        m_required_subgroup_size <= properties.maxSubgroupSize &&
+        (m_required_subgroup_size & (m_required_subgroup_size - 1u)) == 0u;
+
+    if (!supported)
+        std::cerr << "Subgroup size " << m_required_subgroup_size << " is not supported for " << m_shader_path << ", using the default.\n";
+
+    return supported;
+}
+
+VkPipelineShaderStageCreateFlags Compiler_ComputeProgram::get_subgroup_flags(bool required_subgroup_size, const std::array<uint32_t, 3>& workgroup_size) const
+{
+    if (!m_require_full_subgroups)
+        return 0x0;
+
+    if (vk_core::get_enabled_subgroup_size_control_features().computeFullSubgroups != VK_TRUE)
+    {
+        std::cerr << "computeFullSubgroups is not enabled, full subgroups are not required for " << m_shader_path << ".\n";
+        return 0x0;
+    }
+
+    // The x dimension has to be a multiple of the largest subgroup size the pipeline may run with.
+    const uint32_t subgroup_size = required_subgroup_size
+        ? m_required_subgroup_size
+        : vk_core::get_physical_device_subgroup_size_control_properties().maxSubgroupSize;
+
+    if (workgroup_size[0] % subgroup_size != 0u)
+    {
+        std::cerr << "Workgroup size x of " << m_shader_path << " is not a multiple of " << subgroup_size << ", full subgroups are not required.\n";
+        return 0x0;
+    }
+
+    return VK_PIPELINE_SHADER_STAGE_CREATE_REQUIRE_FULL_SUBGROUPS_BIT;
+}
+
+std::array<uint32_t, 3> Compiler_ComputeProgram::get_workgroup_size(const ShaderInterface& shader_interface) const
+{
+    if (m_workgroup_size != std::array<uint32_t, 3>{0u, 0u, 0u})
+        return m_workgroup_size;
+
+    if (shader_interface.workgroup_size == std::array<uint32_t, 3>{0u, 0u, 0u})
+    {
+        std::cerr << "Workgroup size of " << m_shader_path << " is not a literal, set it with set_workgroup_size!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    return shader_interface.workgroup_size;
+}
+
+ComputeProgram Compiler_ComputeProgram::compile() const
+{
+    const VkSpecializationInfo specialization_info = m_specialization.get_info();
+    const ShaderInterface shader_interface = spirv_reflection::reflect(m_shader_path + ".spv", &specialization_info);
+    const std::array<uint32_t, 3> workgroup_size = get_workgroup_size(shader_interface);
+    validate_workgroup_size(workgroup_size, m_shader_path);
+
+    const bool required_subgroup_size = use_required_subgroup_size();
+
+    const VkPipelineShaderStageRequiredSubgroupSizeCreateInfo create_info_subgroup_size {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_REQUIRED_SUBGROUP_SIZE_CREATE_INFO,
+        .pNext = nullptr,
+        .requiredSubgroupSize = m_required_subgroup_size,
+    };
+
+    const VkPipelineShaderStageCreateInfo create_info_shader_stage {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+        .pNext = required_subgroup_size ? &create_info_subgroup_size : nullptr,
+        .flags = get_subgroup_flags(required_subgroup_size, workgroup_size),
+        .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+        .module = shader_module_cache::acquire(m_shader_path + ".spv"),
+        .pName = "main",
+        .pSpecializationInfo = &specialization_info,
+    };
+
+    const VkPipelineLayout vk_handle_pipeline_layout = pipeline_layout_cache::get_pipeline_layout(shader_interface);
+
+    const VkComputePipelineCreateInfo create_info_pipeline {
+        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = descriptor_backend::get_pipeline_create_flags(),
+        .stage = create_info_shader_stage,
+        .layout = vk_handle_pipeline_layout,
+        .basePipelineHandle = VK_NULL_HANDLE,
+        .basePipelineIndex = 0,
+    };
+
+    const VkPipeline vk_handle_pipeline = vk_core::create_compute_pipeline(create_info_pipeline, get_feedback_name().c_str());
+
+    shader_module_cache::release(create_info_shader_stage.module);
+
+    return {vk_handle_pipeline, vk_handle_pipeline_layout, workgroup_size};
+}
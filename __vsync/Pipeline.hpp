@@ -1,13 +1,109 @@
 #include <vulkan/vulkan.h>
 
+#include <array>
 #include <vector>
 #include <string>
+#include <atomic>
+#include <memory>
+#include <inttypes.h>
+
+struct Hasher;
+struct ShaderInterface;
+struct MonolithicPipelineState;
+struct ReflectionCache;
+
+// Pipeline filled in by a compile worker. Poll is_ready() (e.g. once per frame) and keep drawing with a
+// fallback pipeline, or skip the draw, until it is.
+//
+// With graphics pipeline libraries the program first becomes ready with a fast linked pipeline, the link
+// time optimized one replaces it later. get_pipeline_or always returns the best pipeline available.
+//
+// Programs are shared by everyone who compiled the same state, each compile() / compile_async() result
+// has to be destroyed once.
+struct AsyncGraphicsProgram
+{
+private:
+    enum State : uint32_t
+    {
+        Pending = 0,
+        Ready,     // usable, an optimized pipeline may still follow
+        Final,
+    };
+
+    const uint64_t m_key;
+    std::atomic<uint32_t> m_state {Pending};
+    std::atomic<VkPipeline> m_vk_handle_pipeline {VK_NULL_HANDLE};
+    VkPipeline m_vk_handle_fast_link_pipeline {VK_NULL_HANDLE};
+    VkPipelineLayout m_vk_handle_pipeline_layout {VK_NULL_HANDLE};
+public:
+    // key is the state hash the program is shared under.
+    explicit AsyncGraphicsProgram(uint64_t key) : m_key(key) {}
+
+    bool is_ready() const { return m_state.load(std::memory_order_acquire) >= Ready; }
+    bool is_optimized() const { return m_state.load(std::memory_order_acquire) == Final; }
+
+    // The driver failed to create the pipeline, get_pipeline_or keeps returning the fallback.
+    bool has_failed() const;
+
+    // The compiled pipeline, or vk_handle_fallback_pipeline (may be VK_NULL_HANDLE) while it is not ready.
+    VkPipeline get_pipeline_or(VkPipeline vk_handle_fallback_pipeline) const;
+
+    // Blocks until the program is ready.
+    std::pair<VkPipeline, VkPipelineLayout> wait() const;
+
+    void fulfill(std::pair<VkPipeline, VkPipelineLayout> program, bool is_final = true);
+
+    // Swaps in the link time optimized pipeline. The fast linked pipeline is kept until destroy() as
+    // frames that are still in flight may use it.
+    void upgrade(VkPipeline vk_handle_optimized_pipeline);
+
+    // Drops this owner's reference. The last owner waits for the optimized pipeline, then destroys the
+    // pipelines. The layout belongs to pipeline_layout_cache.
+    void destroy();
+};
+
+// Named specialization constant and the values it may take. Values are the constant's 32 bit pattern
+// (VK_TRUE/VK_FALSE for bools), the first value of the domain is the default.
+struct SpecializationConstant
+{
+    std::string name;
+    uint32_t constant_id;
+    std::vector<uint32_t> value_domain;
+};
+
+// One value per specialization constant of a program, in declaration order.
+using VariantKey = std::vector<uint32_t>;
+
+// Specialization constants of a program and the variant selected for the next compile.
+struct ShaderSpecialization
+{
+private:
+    std::vector<SpecializationConstant> m_constant_vec;
+    std::vector<VkSpecializationMapEntry> m_map_entry_vec;
+    VariantKey m_variant_key;
+public:
+    // Resets the variant to the default value of every constant.
+    void set_constants(std::vector<SpecializationConstant>&& constant_vec);
+
+    // Keys are validated against the value domains.
+    void set_variant(const VariantKey& variant_key);
+    VariantKey make_variant_key(const std::vector<std::pair<std::string, uint32_t>>& value_vec) const;
+    const VariantKey& get_variant() const;
+
+    // Every combination of the constants' value domains.
+    std::vector<VariantKey> get_all_variant_keys() const;
+
+    // Points into this object, valid until the constants or the variant change.
+    VkSpecializationInfo get_info() const;
+    void add_to(Hasher& hasher) const;
+};
 
 struct Compiler_GraphicsProgram
 {
 private:
     static std::string m_shader_root_dir;
 
+    std::string m_name;
     std::vector<std::string> m_shader_path_vec;
     std::vector<VkVertexInputBindingDescription> m_vertex_binding_desc_vec;
     std::vector<VkVertexInputAttributeDescription> m_vertex_atrrib_desc_vec;
@@ -24,10 +120,60 @@ private:
     std::pair<float, float> m_min_max_depth;
     std::vector<VkPipelineColorBlendAttachmentState> m_color_attachment_blend_state_vec;
     std::vector<VkFormat> m_color_attachment_format_vec;
+    ShaderSpecialization m_specialization;
+    std::vector<VkDynamicState> m_dynamic_state_vec;
+    VkPushConstantRange m_push_constant_range {0x0, 0u, 0u};
+    uint32_t m_push_desc_set {UINT32_MAX};
+
+    // Reflected shaders per variant, shared with copies of the compiler (compile jobs, warmup variants) and
+    // reused while the paths and content hashes of the shaders stay the same.
+    static std::shared_ptr<ReflectionCache> create_reflection_cache();
+    std::shared_ptr<ReflectionCache> m_reflection_cache {create_reflection_cache()};
+
+    bool is_dynamic_state(VkDynamicState dynamic_state) const;
+
+    // Static state that is dynamic in the program is left out of the library keys, so programs that only
+    // differ in it share libraries.
+    void add_pre_rasterization_state(Hasher& hasher) const;
+    void add_fragment_shader_state(Hasher& hasher) const;
+    void add_fragment_output_state(Hasher& hasher) const;
+
+    std::vector<VkPipelineShaderStageCreateInfo> create_shader_stages(VkShaderStageFlags stage_mask, const VkSpecializationInfo* specialization_info) const;
+
+    // Descriptor sets, push constants and vertex inputs the shaders declare. Vertex inputs and push
+    // constants set explicitly replace the reflected ones.
+    ShaderInterface reflect_shaders() const;
+
+    VkPipelineVertexInputStateCreateInfo get_vertex_input_state(const ShaderInterface& shader_interface) const;
+    VkPipelineInputAssemblyStateCreateInfo get_input_assembly_state() const;
+    VkPipelineViewportStateCreateInfo get_viewport_state() const;
+    VkPipelineRasterizationStateCreateInfo get_rasterization_state() const;
+    VkPipelineMultisampleStateCreateInfo get_multisample_state() const;
+    VkPipelineDepthStencilStateCreateInfo get_depth_stencil_state() const;
+    VkPipelineColorBlendStateCreateInfo get_color_blend_state() const;
+    VkPipelineRenderingCreateInfo get_rendering_info() const;
+    VkPipelineDynamicStateCreateInfo get_dynamic_state() const;
+
+    void fill_monolithic_state(MonolithicPipelineState& state, const ShaderInterface& shader_interface, VkPipelineLayout vk_handle_pipeline_layout) const;
+    std::pair<VkPipeline, VkPipelineLayout> compile_monolithic(const ShaderInterface& shader_interface, VkPipelineLayout vk_handle_pipeline_layout) const;
+
+    // Vertex input interface, pre-rasterization shaders, fragment shader and fragment output interface
+    // libraries, created on first use and cached by a hash of the state that goes into each of them. The
+    // keys only hash content, they are the same in every run.
+    std::array<uint64_t, 4> get_library_keys(const ShaderInterface& shader_interface) const;
+    std::array<VkPipeline, 4> get_pipeline_libraries(const ShaderInterface& shader_interface, VkPipelineLayout vk_handle_pipeline_layout, const std::array<uint64_t, 4>& library_key_array) const;
+    VkPipeline link_pipeline_libraries(const std::array<VkPipeline, 4>& vk_handle_library_array, VkPipelineLayout vk_handle_pipeline_layout, bool optimize) const;
+
+    // Name plus variant, tags the pipeline creation feedback.
+    std::string get_feedback_name() const;
 public:
     static void set_shader_root_dir(const std::string& shader_root_dir);
 
+    // Shown with the pipeline creation feedback, defaults to the shader file names.
+    void set_name(const std::string& name);
     void set_shaders(std::vector<std::string>&& shader_path_vec);
+
+    // Optional, by default the vertex shader inputs are packed into binding 0 in location order.
     void set_vertex_input_bindings(std::vector<VkVertexInputBindingDescription>&& binding_desc_vec);
     void set_vertex_input_attributes(std::vector<VkVertexInputAttributeDescription>&& attribute_desc_vec);
     void set_topology(VkPrimitiveTopology topology);
@@ -39,5 +185,133 @@ public:
     void set_color_attachment_blend_state(const std::vector<VkPipelineColorBlendAttachmentState>& state_vec);
     void set_color_attachment_format(const std::vector<VkFormat>& format_vec);
 
-    std::pair<VkPipeline, VkPipelineLayout> compile();
+    // State set with vkCmdSet* at record time instead of being baked into the pipeline. With
+    // VK_DYNAMIC_STATE_VIEWPORT_WITH_COUNT / SCISSOR_WITH_COUNT set_viewport / set_scissor are ignored.
+    // The color blend states (VK_DYNAMIC_STATE_COLOR_BLEND_*_EXT, VK_DYNAMIC_STATE_COLOR_WRITE_MASK_EXT)
+    // need VK_EXT_extended_dynamic_state3, other states of that extension are not supported and exit.
+    void set_dynamic_state(std::vector<VkDynamicState>&& dynamic_state_vec);
+
+    // Optional, by default the layout has the push constant range the shaders declare. An explicit range
+    // lets programs whose stages use different parts of a block share one layout, it has to cover the
+    // shaders' blocks. Pushed with vk_core::cmd_push_constants.
+    void set_push_constants(VkShaderStageFlags stage_flags, uint32_t size);
+
+    // The set is pushed with vk_core::cmd_push_descriptor_set_KHR while recording instead of being
+    // allocated and bound, for small per-draw data. Needs VK_KHR_push_descriptor, the set holds at most
+    // maxPushDescriptors descriptors and no dynamic buffers or inline uniform blocks.
+    void set_push_descriptor_set(uint32_t set);
+
+    // The same constants are passed to every stage, stages that do not declare a constant ignore it.
+    // Resets the variant to the default value of every constant.
+    void set_specialization_constants(std::vector<SpecializationConstant>&& constant_vec);
+
+    // Selects the variant the next compile builds, keys are validated against the value domains.
+    void set_variant(const VariantKey& variant_key);
+    VariantKey make_variant_key(const std::vector<std::pair<std::string, uint32_t>>& value_vec) const;
+    const VariantKey& get_variant() const;
+
+    // Every combination of the constants' value domains.
+    std::vector<VariantKey> get_all_variant_keys() const;
+
+    bool uses_shader(const std::string& shader_path) const;
+
+    // Hash of everything that goes into the pipeline: the set_* state, the SPIR-V content and the layout.
+    // Stable across runs, programs are shared and recorded for pipeline_warmup under it.
+    uint64_t get_program_key() const;
+
+    // Links cached pipeline libraries with link time optimization when VK_EXT_graphics_pipeline_library is
+    // enabled, builds a monolithic pipeline otherwise. Returns the cached program if the same state was
+    // compiled before, waits for it if it is still being compiled. The program is ready on return.
+    std::shared_ptr<AsyncGraphicsProgram> compile() const;
+
+    // Copies the compiler state and queues it on the pipeline compile workers. Compiles on the calling
+    // thread if no workers were started. Requests for state that is already compiled or queued share
+    // that program instead.
+    std::shared_ptr<AsyncGraphicsProgram> compile_async() const;
+
+    // Used by the compile workers. With pipeline libraries and fast_link program becomes ready after the
+    // fast link and is upgraded once the optimized link is done.
+    void compile_into(AsyncGraphicsProgram& program, bool fast_link = true) const;
+
+    // Queues many programs at once, e.g. everything a level needs. New programs are split into batches
+    // over the compile workers and each batch is created with a single vkCreateGraphicsPipelines call.
+    // Programs that fail are reported and report has_failed(), the rest of the batch is unaffected.
+    static std::vector<std::shared_ptr<AsyncGraphicsProgram>> compile_batch_async(const std::vector<Compiler_GraphicsProgram>& compiler_vec);
+
+    // Used by the compile workers, compiles the programs with one pipeline creation call.
+    static void compile_batch_into(const std::vector<Compiler_GraphicsProgram>& compiler_vec, const std::vector<std::shared_ptr<AsyncGraphicsProgram>>& program_vec);
+
+    static bool uses_pipeline_libraries();
+    static void destroy_pipeline_library_cache();
+};
+
+// Compute pipeline and the workgroup size it was compiled with, dispatches are sized from problem dimensions.
+struct ComputeProgram
+{
+    VkPipeline vk_handle_pipeline;
+    VkPipelineLayout vk_handle_pipeline_layout;
+    std::array<uint32_t, 3> workgroup_size;
+
+    // Enough workgroups to cover problem_size, the shader has to bounds check the last ones.
+    std::array<uint32_t, 3> get_group_count(const std::array<uint32_t, 3>& problem_size) const;
+    // For indirect arguments written by the CPU.
+    VkDispatchIndirectCommand get_dispatch_indirect_command(const std::array<uint32_t, 3>& problem_size) const;
+
+    // Bind the pipeline and dispatch.
+    void dispatch(VkCommandBuffer vk_handle_cmd_buff, const std::array<uint32_t, 3>& problem_size) const;
+    void dispatch_indirect(VkCommandBuffer vk_handle_cmd_buff, VkBuffer vk_handle_indirect_buffer, VkDeviceSize offset) const;
+
+    // Destroys the pipeline, the layout belongs to pipeline_layout_cache.
+    void destroy();
+};
+
+struct Compiler_ComputeProgram
+{
+private:
+    std::string m_name;
+    std::string m_shader_path;
+    std::array<uint32_t, 3> m_workgroup_size {0u, 0u, 0u};
+    uint32_t m_required_subgroup_size {0u};
+    bool m_require_full_subgroups {false};
+    ShaderSpecialization m_specialization;
+
+    // Subgroup size control that the device supports, unsupported requests are dropped with a warning.
+    bool use_required_subgroup_size() const;
+    VkPipelineShaderStageCreateFlags get_subgroup_flags(bool required_subgroup_size, const std::array<uint32_t, 3>& workgroup_size) const;
+
+    // The size set with set_workgroup_size, the shader's LocalSize otherwise.
+    std::array<uint32_t, 3> get_workgroup_size(const ShaderInterface& shader_interface) const;
+    std::string get_feedback_name() const;
+public:
+    // Shown with the pipeline creation feedback, defaults to the shader file name.
+    void set_name(const std::string& name);
+    void set_shader(const std::string& shader_path);
+
+    // Optional unless the local size is a specialization constant, it has to match the size the shader is compiled with.
+    // Sizes have to be non-zero within maxComputeWorkGroupSize and maxComputeWorkGroupInvocations.
+    void set_workgroup_size(const std::array<uint32_t, 3>& workgroup_size);
+
+    // 0 leaves the choice to the driver. Needs the subgroupSizeControl feature enabled and compute in
+    // requiredSubgroupSizeStages, otherwise it is dropped with a warning.
+    void set_required_subgroup_size(uint32_t subgroup_size);
+    // Every subgroup is fully populated, needs the computeFullSubgroups feature enabled.
+    void set_require_full_subgroups(bool require_full_subgroups);
+
+    void set_specialization_constants(std::vector<SpecializationConstant>&& constant_vec);
+    void set_variant(const VariantKey& variant_key);
+    VariantKey make_variant_key(const std::vector<std::pair<std::string, uint32_t>>& value_vec) const;
+    const VariantKey& get_variant() const;
+    std::vector<VariantKey> get_all_variant_keys() const;
+
+    ComputeProgram compile() const;
+};
+
+namespace pipeline_compile_workers
+{
+    void start(uint32_t worker_count);
+    // Finishes all queued compiles before joining the workers.
+    void stop();
+
+    // Number of compiles finished since the previous call, meant to be reported once per frame.
+    uint32_t take_completed_count();
 };
\ No newline at end of file
@@ -0,0 +1,174 @@
+#include "PipelineLayoutCache.hpp"
+#include "BindlessTable.hpp"
+#include "DescriptorBuffer.hpp"
+#include "Hash.hpp"
+#include "ObjectCache.hpp"
+#include "vk_core.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace
+{
+    std::mutex cache_mutex;
+    std::unordered_set<VkDescriptorSetLayout> desc_set_layout_set;           // one object_cache reference each
+    std::unordered_map<uint64_t, VkPipelineLayout> pipeline_layout_map;      // set layouts + push constants hash -> layout
+
+    // object_cache deduplicates the layouts, the cache only holds one reference per layout until destroy().
+    VkDescriptorSetLayout get_desc_set_layout_locked(const std::vector<VkDescriptorSetLayoutBinding>& binding_vec, VkDescriptorSetLayoutCreateFlags flags = 0x0)
+    {
+        const VkDescriptorSetLayout vk_handle_desc_set_layout = object_cache::acquire_desc_set_layout({
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = flags | descriptor_backend::get_desc_set_layout_flags(),
+            .bindingCount = static_cast<uint32_t>(binding_vec.size()),
+            .pBindings = binding_vec.data(),
+        });
+
+        if (!desc_set_layout_set.insert(vk_handle_desc_set_layout).second)
+            object_cache::release_desc_set_layout(vk_handle_desc_set_layout);
+
+        return vk_handle_desc_set_layout;
+    }
+
+    bool has_runtime_array(const std::vector<VkDescriptorSetLayoutBinding>& binding_vec)
+    {
+        return std::any_of(binding_vec.begin(), binding_vec.end(), [](const VkDescriptorSetLayoutBinding& binding) { return binding.descriptorCount == 0u; });
+    }
+
+    // Push descriptor set layouts cannot hold dynamic buffers or inline uniform blocks, and all of their
+    // descriptors count against maxPushDescriptors.
+    void validate_push_desc_set(uint32_t set, const std::vector<VkDescriptorSetLayoutBinding>& binding_vec)
+    {
+        if (has_runtime_array(binding_vec))
+        {
+            std::cerr << "Push descriptor set " << set << " cannot hold runtime arrays!\n";
+            exit(EXIT_FAILURE);
+        }
+
+        uint32_t desc_count = 0u;
+
+        for (const VkDescriptorSetLayoutBinding& binding : binding_vec)
+        {
+            if (binding.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC ||
+                binding.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC ||
+                binding.descriptorType == VK_DESCRIPTOR_TYPE_INLINE_UNIFORM_BLOCK)
+            {
+                std::cerr << "Push descriptor set " << set << " cannot hold binding " << binding.binding << " of descriptor type " << binding.descriptorType << "!\n";
+                exit(EXIT_FAILURE);
+            }
+
+            desc_count += binding.descriptorCount;
+        }
+
+        const uint32_t max_push_desc_count = vk_core::get_physical_device_push_descriptor_properties().maxPushDescriptors;
+
+        if (desc_count > max_push_desc_count)
+        {
+            std::cerr << "Push descriptor set " << set << " has " << desc_count << " descriptors, the device pushes at most " << max_push_desc_count << "!\n";
+            exit(EXIT_FAILURE);
+        }
+    }
+};
+
+VkDescriptorSetLayout pipeline_layout_cache::get_desc_set_layout(const std::vector<VkDescriptorSetLayoutBinding>& binding_vec)
+{
+    std::lock_guard lock(cache_mutex);
+    return get_desc_set_layout_locked(binding_vec);
+}
+
+VkPipelineLayout pipeline_layout_cache::get_pipeline_layout(const ShaderInterface& shader_interface)
+{
+    std::lock_guard lock(cache_mutex);
+
+    // Sets are indexed by position, sets a program skips get an empty layout. Sets with runtime arrays are the
+    // bindless table.
+    uint32_t desc_set_count = shader_interface.desc_set_binding_map.empty() ? 0u : shader_interface.desc_set_binding_map.rbegin()->first + 1u;
+
+    if (shader_interface.push_desc_set != UINT32_MAX)
+    {
+        if (!vk_core::is_device_extension_enabled(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME))
+        {
+            std::cerr << "Push descriptor set " << shader_interface.push_desc_set << " needs VK_KHR_push_descriptor!\n";
+            exit(EXIT_FAILURE);
+        }
+
+        desc_set_count = std::max(desc_set_count, shader_interface.push_desc_set + 1u);
+    }
+
+    std::vector<VkDescriptorSetLayout> desc_set_layout_vec(desc_set_count);
+
+    for (uint32_t i = 0; i < desc_set_count; i++)
+    {
+        const auto it = shader_interface.desc_set_binding_map.find(i);
+
+        if (i == shader_interface.push_desc_set)
+        {
+            const std::vector<VkDescriptorSetLayoutBinding> binding_vec = (it != shader_interface.desc_set_binding_map.end()) ? it->second : std::vector<VkDescriptorSetLayoutBinding>{};
+
+            validate_push_desc_set(i, binding_vec);
+
+            desc_set_layout_vec[i] = get_desc_set_layout_locked(binding_vec, VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR);
+        }
+        else if (it != shader_interface.desc_set_binding_map.end() && has_runtime_array(it->second))
+            desc_set_layout_vec[i] = bindless_table::get_compatible_desc_set_layout(it->second);
+        else
+            desc_set_layout_vec[i] = get_desc_set_layout_locked((it != shader_interface.desc_set_binding_map.end()) ? it->second : std::vector<VkDescriptorSetLayoutBinding>{});
+    }
+
+    Hasher hasher;
+    hasher.add(desc_set_layout_vec);
+    hasher.add(shader_interface.push_constant_range_vec);
+
+    const auto it = pipeline_layout_map.find(hasher.value);
+
+    if (it != pipeline_layout_map.end())
+        return it->second;
+
+    const VkPipelineLayout vk_handle_pipeline_layout = vk_core::create_pipeline_layout({
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .setLayoutCount = static_cast<uint32_t>(desc_set_layout_vec.size()),
+        .pSetLayouts = desc_set_layout_vec.data(),
+        .pushConstantRangeCount = static_cast<uint32_t>(shader_interface.push_constant_range_vec.size()),
+        .pPushConstantRanges = shader_interface.push_constant_range_vec.data(),
+    });
+
+    pipeline_layout_map.emplace(hasher.value, vk_handle_pipeline_layout);
+
+    return vk_handle_pipeline_layout;
+}
+
+uint64_t pipeline_layout_cache::get_layout_key(const ShaderInterface& shader_interface)
+{
+    Hasher hasher;
+
+    for (const auto& [set, binding_vec] : shader_interface.desc_set_binding_map)
+    {
+        hasher.add(set);
+        hasher.add(binding_vec);
+    }
+
+    hasher.add(shader_interface.push_constant_range_vec);
+    hasher.add(shader_interface.push_desc_set);
+
+    return hasher.value;
+}
+
+void pipeline_layout_cache::destroy()
+{
+    std::lock_guard lock(cache_mutex);
+
+    for (const auto& [hash, vk_handle_pipeline_layout] : pipeline_layout_map)
+        vk_core::destroy_pipeline_layout(vk_handle_pipeline_layout);
+
+    for (const VkDescriptorSetLayout vk_handle_desc_set_layout : desc_set_layout_set)
+        object_cache::release_desc_set_layout(vk_handle_desc_set_layout);
+
+    pipeline_layout_map.clear();
+    desc_set_layout_set.clear();
+}
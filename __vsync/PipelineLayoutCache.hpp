@@ -0,0 +1,25 @@
+#ifndef PIPELINE_LAYOUT_CACHE_HPP
+#define PIPELINE_LAYOUT_CACHE_HPP
+
+#include "SpirvReflection.hpp"
+
+#include <vulkan/vulkan.h>
+
+// Descriptor set layouts and pipeline layouts built from reflected shader interfaces. Both are deduplicated
+// by content, so programs declaring the same resources share one layout and can share pipeline libraries.
+//
+// The cache owns every layout it returns, they live until destroy(). Set layouts are referenced from
+// object_cache, identical layouts created elsewhere are the same handle.
+namespace pipeline_layout_cache
+{
+    VkPipelineLayout get_pipeline_layout(const ShaderInterface& shader_interface);
+    VkDescriptorSetLayout get_desc_set_layout(const std::vector<VkDescriptorSetLayoutBinding>& binding_vec);
+
+    // Hash of the sets and push constants get_pipeline_layout builds the layout from. Unlike the handle it
+    // is the same in every run.
+    uint64_t get_layout_key(const ShaderInterface& shader_interface);
+
+    void destroy();
+};
+
+#endif
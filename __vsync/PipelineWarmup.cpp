@@ -0,0 +1,175 @@
+#include "PipelineWarmup.hpp"
+#include "Pipeline.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+#include <stdio.h>
+
+namespace
+{
+    constexpr uint32_t manifest_magic = 0x50575550u; // "PUWP"
+    constexpr uint32_t manifest_version = 1u;
+
+    struct ManifestHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t entry_count;
+    };
+
+    struct ManifestEntry
+    {
+        uint64_t program_key;
+        uint64_t first_use_frame;
+    };
+
+    std::string manifest_path;
+    std::unordered_map<uint64_t, uint64_t> manifest_frame_map;  // program key -> first use frame, previous session
+
+    std::mutex record_mutex;
+    std::unordered_map<uint64_t, uint64_t> record_frame_map;    // program key -> first use frame, this session
+    uint64_t frame_index = 0u;
+};
+
+void pipeline_warmup::load(const std::string& path)
+{
+    manifest_path = path;
+    manifest_frame_map.clear();
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+
+    if (!file.is_open())
+        return;
+
+    const size_t file_size = static_cast<size_t>(file.tellg());
+    file.seekg(0);
+
+    ManifestHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+    if (!file.good() || header.magic != manifest_magic || header.version != manifest_version ||
+        file_size != sizeof(header) + header.entry_count * sizeof(ManifestEntry))
+    {
+        std::cerr << "Pipeline warm-up manifest " << path << " is invalid, starting empty.\n";
+        return;
+    }
+
+    std::vector<ManifestEntry> entry_vec(header.entry_count);
+    file.read(reinterpret_cast<char*>(entry_vec.data()), entry_vec.size() * sizeof(ManifestEntry));
+
+    for (const ManifestEntry& entry : entry_vec)
+        manifest_frame_map.emplace(entry.program_key, entry.first_use_frame);
+}
+
+void pipeline_warmup::record(uint64_t program_key)
+{
+    std::lock_guard lock(record_mutex);
+    record_frame_map.try_emplace(program_key, frame_index);
+}
+
+void pipeline_warmup::next_frame()
+{
+    std::lock_guard lock(record_mutex);
+    frame_index++;
+}
+
+std::vector<std::shared_ptr<AsyncGraphicsProgram>> pipeline_warmup::precompile(const std::vector<Compiler_GraphicsProgram>& candidate_vec)
+{
+    std::vector<std::pair<uint64_t, size_t>> warmup_vec; // first use frame, candidate index
+    std::vector<uint64_t> key_vec;
+
+    for (size_t i = 0; i < candidate_vec.size(); i++)
+    {
+        const uint64_t program_key = candidate_vec[i].get_program_key();
+        const auto it = manifest_frame_map.find(program_key);
+
+        if (it == manifest_frame_map.end())
+            continue;
+
+        warmup_vec.emplace_back(it->second, i);
+        key_vec.push_back(program_key);
+    }
+
+    // Stable so candidates first used on the same frame keep the application's order.
+    std::vector<size_t> order_vec(warmup_vec.size());
+
+    for (size_t i = 0; i < order_vec.size(); i++)
+        order_vec[i] = i;
+
+    std::stable_sort(order_vec.begin(), order_vec.end(), [&](size_t lhs, size_t rhs) { return warmup_vec[lhs].first < warmup_vec[rhs].first; });
+
+    std::vector<Compiler_GraphicsProgram> compiler_vec;
+    compiler_vec.reserve(order_vec.size());
+
+    for (const size_t i : order_vec)
+        compiler_vec.push_back(candidate_vec[warmup_vec[i].second]);
+
+    // compile_batch_async records the programs on the current frame, the ones the application has not
+    // requested yet keep their manifest frame.
+    std::vector<bool> requested_vec(key_vec.size());
+
+    {
+        std::lock_guard lock(record_mutex);
+
+        for (size_t i = 0; i < key_vec.size(); i++)
+            requested_vec[i] = record_frame_map.contains(key_vec[i]);
+    }
+
+    std::vector<std::shared_ptr<AsyncGraphicsProgram>> program_vec = Compiler_GraphicsProgram::compile_batch_async(compiler_vec);
+
+    {
+        std::lock_guard lock(record_mutex);
+
+        for (size_t i = 0; i < key_vec.size(); i++)
+        {
+            if (!requested_vec[i])
+                record_frame_map[key_vec[i]] = warmup_vec[i].first;
+        }
+    }
+
+    return program_vec;
+}
+
+void pipeline_warmup::save()
+{
+    if (manifest_path.empty())
+        return;
+
+    std::vector<ManifestEntry> entry_vec;
+
+    {
+        std::lock_guard lock(record_mutex);
+
+        for (const auto& [program_key, first_use_frame] : record_frame_map)
+            entry_vec.push_back({program_key, first_use_frame});
+    }
+
+    std::sort(entry_vec.begin(), entry_vec.end(), [](const ManifestEntry& lhs, const ManifestEntry& rhs) { return lhs.first_use_frame < rhs.first_use_frame; });
+
+    const ManifestHeader header {
+        .magic = manifest_magic,
+        .version = manifest_version,
+        .entry_count = entry_vec.size(),
+    };
+
+    // Written next to the target and renamed over it, a crash while saving keeps the previous manifest.
+    const std::string tmp_path = manifest_path + ".tmp";
+
+    {
+        std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(entry_vec.data()), entry_vec.size() * sizeof(ManifestEntry));
+
+        if (!file.good())
+        {
+            std::cerr << "Failed to write pipeline warm-up manifest " << tmp_path << "!\n";
+            return;
+        }
+    }
+
+    if (rename(tmp_path.c_str(), manifest_path.c_str()) != 0)
+        std::cerr << "Failed to replace pipeline warm-up manifest " << manifest_path << "!\n";
+}
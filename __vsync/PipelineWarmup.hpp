@@ -0,0 +1,39 @@
+#ifndef PIPELINE_WARMUP_HPP
+#define PIPELINE_WARMUP_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <inttypes.h>
+
+struct AsyncGraphicsProgram;
+struct Compiler_GraphicsProgram;
+
+// Manifest of the graphics programs a session compiled and the frame each was first requested on. The
+// next launch precompiles them on the compile workers, in first use order, before the frames that need
+// them are drawn.
+//
+// Programs are identified by their program key, which only hashes content, so the manifest can only name
+// programs, the application still has to configure them. precompile() picks the ones the manifest names
+// out of everything the application may draw with.
+namespace pipeline_warmup
+{
+    // Loads the previous session's manifest, a missing or invalid file starts an empty one.
+    void load(const std::string& manifest_path);
+
+    // Called by the compilers for every program requested. Only the first request of a program counts.
+    void record(uint64_t program_key);
+
+    // Advances the frame requests are recorded on, call once per frame.
+    void next_frame();
+
+    // Queues the candidates the manifest names, earliest first use first. Hold on to the returned
+    // programs until shutdown, the cache drops a program with its last owner.
+    std::vector<std::shared_ptr<AsyncGraphicsProgram>> precompile(const std::vector<Compiler_GraphicsProgram>& candidate_vec);
+
+    // Writes the programs recorded and precompiled this session. Entries of the loaded manifest that
+    // matched no candidate are dropped, they belong to shaders or state that changed since.
+    void save();
+};
+
+#endif
@@ -0,0 +1,112 @@
+#include "PresentThread.hpp"
+#include "vk_core.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+static uint64_t get_time()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Image index that tells the present thread to exit.
+static constexpr uint32_t stop_request_idx = UINT32_MAX;
+
+void PresentThread::start(uint32_t frames_in_flight)
+{
+    const uint32_t image_count = static_cast<uint32_t>(vk_core::get_swapchain_image_count());
+    const uint32_t max_acquired_ahead = image_count > frames_in_flight ? image_count - frames_in_flight : 1u;
+
+    // Acquires wait forever, so the count is capped where vkAcquireNextImageKHR still returns without a present.
+    m_max_acquired_count = std::min({max_acquired_ahead + 1u, vk_core::get_max_acquired_swapchain_image_count(), acquired_image_queue_capacity});
+
+    m_vk_handle_acquire_fence = vk_core::create_fence("Present Thread - Acquire Fence");
+    m_thread = std::thread(&PresentThread::run, this);
+}
+
+void PresentThread::stop()
+{
+    m_present_request_queue.push({
+        .swapchain_image_idx = stop_request_idx,
+        .vk_handle_wait_sem4 = VK_NULL_HANDLE,
+        .present_id = 0u,
+    });
+
+    m_thread.join();
+    vk_core::destroy_fence(m_vk_handle_acquire_fence);
+}
+
+uint32_t PresentThread::pop_acquired_image()
+{
+    return m_acquired_image_queue.pop();
+}
+
+void PresentThread::push_present(const PresentRequest& request)
+{
+    m_present_request_queue.push(request);
+}
+
+void PresentThread::record_blocking_time(const char* name, uint64_t start_ns)
+{
+    // Dropped if the main thread stops draining, blocking times are diagnostics only.
+    m_blocking_time_queue.try_push({name, start_ns, get_time()});
+}
+
+void PresentThread::acquire()
+{
+    const uint64_t start_ns = get_time();
+
+    // Waiting on the fence (rather than handing out a semaphore) means the presentation engine is
+    // done with the image by the time its index is pushed.
+    const uint32_t swapchain_image_idx = vk_core::acquire_next_swapchain_image(VK_NULL_HANDLE, m_vk_handle_acquire_fence);
+    vk_core::wait_for_fence(m_vk_handle_acquire_fence, UINT64_MAX);
+    vk_core::reset_fence(m_vk_handle_acquire_fence);
+
+    record_blocking_time("Present Thread - Acquire", start_ns);
+
+    m_acquired_image_queue.push(swapchain_image_idx);
+}
+
+void PresentThread::run()
+{
+    uint32_t acquired_count = 0u;
+
+    while (true)
+    {
+        PresentRequest request;
+
+        // Presents hand images back to the presentation engine, acquire ahead only while none are pending.
+        if (!m_present_request_queue.try_pop(request))
+        {
+            if (acquired_count < m_max_acquired_count)
+            {
+                acquire();
+                acquired_count++;
+                continue;
+            }
+
+            request = m_present_request_queue.pop();
+        }
+
+        if (request.swapchain_image_idx == stop_request_idx)
+            break;
+
+        const uint64_t start_ns = get_time();
+
+        vk_core::set_latency_marker_NV(request.present_id, VK_LATENCY_MARKER_PRESENT_START_NV);
+
+        const VkPresentIdKHR present_id_obj {
+            .sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR,
+            .pNext = nullptr,
+            .swapchainCount = 1u,
+            .pPresentIds = &request.present_id,
+        };
+
+        vk_core::present(request.swapchain_image_idx, {request.vk_handle_wait_sem4}, (void*)(&present_id_obj));
+        acquired_count--;
+
+        vk_core::set_latency_marker_NV(request.present_id, VK_LATENCY_MARKER_PRESENT_END_NV);
+
+        record_blocking_time("Present Thread - Present", start_ns);
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef PRESENT_THREAD_HPP
+#define PRESENT_THREAD_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <thread>
+#include <inttypes.h>
+
+#include "SpscQueue.hpp"
+
+// Owns vkAcquireNextImageKHR and vkQueuePresentKHR so that blocking in either (FIFO, compositor
+// back-pressure) happens off the thread that polls input and records frames.
+//
+// Pending presents go first, in between the thread acquires images ahead until image count - frames in
+// flight are queued (at least one, within what vkAcquireNextImageKHR allows without presenting). Every
+// acquire waits on the acquire fence, so a popped image index is immediately ready for rendering.
+struct PresentThread
+{
+public:
+    struct PresentRequest
+    {
+        uint32_t swapchain_image_idx;
+        VkSemaphore vk_handle_wait_sem4;
+        uint64_t present_id;
+    };
+
+    struct BlockingTime
+    {
+        const char* name;
+        uint64_t start_ns;
+        uint64_t end_ns;
+    };
+
+private:
+    static constexpr uint32_t acquired_image_queue_capacity = 8u;
+
+    std::thread m_thread;
+    VkFence m_vk_handle_acquire_fence {VK_NULL_HANDLE};
+    uint32_t m_max_acquired_count {1u};     // acquired and not presented, including the one being rendered
+
+    SpscQueue<uint32_t, acquired_image_queue_capacity> m_acquired_image_queue;
+    SpscQueue<PresentRequest, 4> m_present_request_queue;
+    SpscQueue<BlockingTime, 64> m_blocking_time_queue;
+
+    void run();
+    void acquire();
+    void record_blocking_time(const char* name, uint64_t start_ns);
+
+public:
+    // frames_in_flight is the number of frames the render thread records ahead of the GPU.
+    void start(uint32_t frames_in_flight);
+    void stop();
+
+    // Blocks until the present thread has an image ready.
+    uint32_t pop_acquired_image();
+    void push_present(const PresentRequest& request);
+
+    // Hands blocking times recorded by the present thread to func(const BlockingTime&) on the calling thread.
+    template<typename Func>
+    void drain_blocking_times(Func&& func)
+    {
+        BlockingTime blocking_time;
+
+        while (m_blocking_time_queue.try_pop(blocking_time))
+            func(blocking_time);
+    }
+};
+
+#endif
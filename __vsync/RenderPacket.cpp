@@ -0,0 +1,54 @@
+#include "RenderPacket.hpp"
+
+#include <cstring>
+
+namespace
+{
+    // ImVector's assignment frees and reallocates, resize keeps the capacity from previous frames.
+    template<typename T>
+    void copy_im_vector(ImVector<T>& dst, const ImVector<T>& src)
+    {
+        dst.resize(src.Size);
+
+        if (src.Size > 0)
+            memcpy(dst.Data, src.Data, static_cast<size_t>(src.Size) * sizeof(T));
+    }
+};
+
+void UiDrawData::copy(const ImDrawData* src_draw_data)
+{
+    clear();
+
+    if (src_draw_data == nullptr || !src_draw_data->Valid)
+        return;
+
+    while (m_draw_list_vec.size() < static_cast<size_t>(src_draw_data->CmdListsCount))
+        m_draw_list_vec.push_back(std::make_unique<ImDrawList>(nullptr));
+
+    for (int i = 0; i < src_draw_data->CmdListsCount; i++)
+    {
+        const ImDrawList* src_draw_list = src_draw_data->CmdLists[i];
+        ImDrawList* dst_draw_list = m_draw_list_vec[i].get();
+
+        copy_im_vector(dst_draw_list->CmdBuffer, src_draw_list->CmdBuffer);
+        copy_im_vector(dst_draw_list->IdxBuffer, src_draw_list->IdxBuffer);
+        copy_im_vector(dst_draw_list->VtxBuffer, src_draw_list->VtxBuffer);
+        dst_draw_list->Flags = src_draw_list->Flags;
+
+        draw_data.CmdLists.push_back(dst_draw_list);
+    }
+
+    draw_data.Valid = true;
+    draw_data.CmdListsCount = src_draw_data->CmdListsCount;
+    draw_data.TotalIdxCount = src_draw_data->TotalIdxCount;
+    draw_data.TotalVtxCount = src_draw_data->TotalVtxCount;
+    draw_data.DisplayPos = src_draw_data->DisplayPos;
+    draw_data.DisplaySize = src_draw_data->DisplaySize;
+    draw_data.FramebufferScale = src_draw_data->FramebufferScale;
+    draw_data.OwnerViewport = src_draw_data->OwnerViewport;
+}
+
+void UiDrawData::clear()
+{
+    draw_data.Clear();
+}
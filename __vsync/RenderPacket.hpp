@@ -0,0 +1,71 @@
+#ifndef RENDER_PACKET_HPP
+#define RENDER_PACKET_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <inttypes.h>
+
+#include "imgui.h"
+
+// State the programs leave dynamic, set before each draw. Viewport and scissor follow the camera.
+struct DynamicGraphicsState
+{
+    VkCullModeFlags cull_mode;
+    VkBool32 blend_enable;                 // VK_EXT_extended_dynamic_state3 only
+    VkColorBlendEquationEXT blend_equation; // VK_EXT_extended_dynamic_state3 only
+};
+
+struct DrawCommand
+{
+    VkPipeline vk_handle_pipeline;
+    DynamicGraphicsState dynamic_state;
+    uint32_t vertex_count;
+    uint32_t instance_count;
+};
+
+// There is no scene transform yet, the camera only describes the view that is rendered into.
+struct Camera
+{
+    VkExtent2D extent;
+    VkClearColorValue clear_color;
+};
+
+// Deep copy of the draw data returned by ImGui::Render(). ImGui's draw lists are only valid until the
+// next ImGui::NewFrame(), the copy lets the main thread build the next UI while this one is recorded.
+// Draw list storage is kept between copies so a steady UI does not allocate.
+struct UiDrawData
+{
+private:
+    std::vector<std::unique_ptr<ImDrawList>> m_draw_list_vec;
+
+public:
+    ImDrawData draw_data;
+
+    void copy(const ImDrawData* src_draw_data);
+    void clear();
+};
+
+// Everything the render thread needs for one frame. Built by the main thread and read-only once published.
+struct RenderPacket
+{
+    uint64_t frame_id;
+    Camera camera;
+    std::vector<DrawCommand> draw_cmd_vec;
+    UiDrawData ui_draw_data;
+
+    // Objects the main thread stopped using while building this packet (e.g. a pipeline replaced by a
+    // shader reload). Destroyed once the GPU finished the frame recorded from this packet.
+    std::vector<std::function<void()>> deferred_destroy_vec;
+
+#ifdef DEBUG
+    // CPU time ranges the main thread spent building this packet, merged into the frame's stats.
+    std::vector<std::pair<std::string, std::array<uint64_t, 2>>> main_thread_cpu_data;
+#endif
+};
+
+#endif
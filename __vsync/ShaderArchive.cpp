@@ -0,0 +1,97 @@
+#include "ShaderArchive.hpp"
+
+#include <iostream>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    const void* archive_data = nullptr;
+    size_t archive_size = 0u;
+    std::unordered_map<std::string, SpirvBlob> blob_map; // spirv_dir + name -> module
+
+    [[noreturn]] void exit_invalid_archive(const std::string& archive_path, const char* reason)
+    {
+        std::cerr << "Invalid shader archive " << archive_path << ": " << reason << "!\n";
+        exit(EXIT_FAILURE);
+    }
+};
+
+void shader_archive::open(const std::string& archive_path, const std::string& spirv_dir)
+{
+    const int fd = ::open(archive_path.c_str(), O_RDONLY);
+    struct stat file_stat;
+
+    if (fd < 0 || fstat(fd, &file_stat) != 0)
+    {
+        std::cerr << "Failed to open shader archive " << archive_path << ", loading SPIR-V files.\n";
+
+        if (fd >= 0)
+            ::close(fd);
+
+        return;
+    }
+
+    archive_size = static_cast<size_t>(file_stat.st_size);
+    void* data = mmap(nullptr, archive_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // The mapping keeps the file referenced, the descriptor is not needed anymore.
+    ::close(fd);
+
+    if (data == MAP_FAILED)
+    {
+        std::cerr << "Failed to map file " << archive_path << "!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    archive_data = data;
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(archive_data);
+    const ShaderArchiveHeader* header = static_cast<const ShaderArchiveHeader*>(archive_data);
+
+    if (archive_size < sizeof(ShaderArchiveHeader) || header->magic != shader_archive_magic || header->version != shader_archive_version)
+        exit_invalid_archive(archive_path, "unknown format");
+
+    const size_t entry_table_end = sizeof(ShaderArchiveHeader) + header->entry_count * sizeof(ShaderArchiveEntry);
+
+    if (entry_table_end + header->name_table_size > archive_size)
+        exit_invalid_archive(archive_path, "truncated");
+
+    const ShaderArchiveEntry* entry_array = reinterpret_cast<const ShaderArchiveEntry*>(bytes + sizeof(ShaderArchiveHeader));
+    const char* name_table = reinterpret_cast<const char*>(bytes + entry_table_end);
+
+    for (uint32_t i = 0; i < header->entry_count; i++)
+    {
+        const ShaderArchiveEntry& entry = entry_array[i];
+
+        if (entry.name_offset + entry.name_size > header->name_table_size ||
+            entry.data_offset + entry.data_size > archive_size || entry.data_offset % sizeof(uint32_t) != 0u)
+            exit_invalid_archive(archive_path, "entry out of bounds");
+
+        blob_map.emplace(spirv_dir + std::string(name_table + entry.name_offset, entry.name_size), SpirvBlob {
+            .code = reinterpret_cast<const uint32_t*>(bytes + entry.data_offset),
+            .size = entry.data_size,
+            .content_hash = entry.content_hash,
+        });
+    }
+}
+
+void shader_archive::close()
+{
+    if (archive_data != nullptr)
+        munmap(const_cast<void*>(archive_data), archive_size);
+
+    archive_data = nullptr;
+    archive_size = 0u;
+    blob_map.clear();
+}
+
+const SpirvBlob* shader_archive::find(const std::string& spirv_path)
+{
+    const auto it = blob_map.find(spirv_path);
+    return (it != blob_map.end()) ? &it->second : nullptr;
+}
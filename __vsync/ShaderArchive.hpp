@@ -0,0 +1,49 @@
+#ifndef SHADER_ARCHIVE_HPP
+#define SHADER_ARCHIVE_HPP
+
+#include <string>
+#include <inttypes.h>
+#include <stddef.h>
+
+// Archive written by vsync_shader_pack: header, entries sorted by name, name table, then the SPIR-V of
+// every module. Module data is 4 byte aligned so it can be handed to the driver from the mapping.
+constexpr uint32_t shader_archive_magic = 0x4b505653u; // "SVPK"
+constexpr uint32_t shader_archive_version = 1u;
+
+struct ShaderArchiveHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entry_count;
+    uint32_t name_table_size;
+};
+
+struct ShaderArchiveEntry
+{
+    uint64_t content_hash; // Hasher over the SPIR-V, the same hash shader_module_cache computes for files
+    uint64_t data_offset;
+    uint64_t data_size;
+    uint32_t name_offset;
+    uint32_t name_size;
+};
+
+struct SpirvBlob
+{
+    const uint32_t* code;
+    size_t size;
+    uint64_t content_hash;
+};
+
+// The archive is mapped once and read without locking, open it before the first compile and close it
+// after the last one.
+namespace shader_archive
+{
+    // Modules are found by spirv_dir + name, the paths the compilers use for loose SPIR-V files.
+    void open(const std::string& archive_path, const std::string& spirv_dir);
+    void close();
+
+    // nullptr if no archive is open or it does not have the module, the caller falls back to the file.
+    const SpirvBlob* find(const std::string& spirv_path);
+};
+
+#endif
@@ -0,0 +1,241 @@
+#include "ShaderHotReload.hpp"
+
+#include <shaderc/shaderc.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <utility>
+
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace
+{
+    struct IncludeData
+    {
+        std::string source_name;
+        std::string content;
+        shaderc_include_result result;
+    };
+
+    // Resolves #include "file" next to the including file and #include <file> in the GLSL directory, the
+    // same lookup glslc does for the vsync_shaders target.
+    struct GlslIncluder : public shaderc::CompileOptions::IncluderInterface
+    {
+        std::string glsl_dir;
+
+        explicit GlslIncluder(const std::string& glsl_dir) : glsl_dir(glsl_dir) {}
+
+        shaderc_include_result* GetInclude(const char* requested_source, shaderc_include_type type, const char* requesting_source, size_t) override
+        {
+            auto* p_data = new IncludeData();
+
+            std::string include_path = glsl_dir + requested_source;
+
+            if (type == shaderc_include_type_relative)
+            {
+                const std::string requesting_path = requesting_source;
+                const size_t dir_end = requesting_path.find_last_of('/');
+                include_path = (dir_end == std::string::npos ? std::string() : requesting_path.substr(0u, dir_end + 1u)) + requested_source;
+            }
+
+            std::ifstream include_file(include_path);
+
+            if (include_file.is_open())
+            {
+                std::stringstream include_source;
+                include_source << include_file.rdbuf();
+
+                p_data->source_name = include_path;
+                p_data->content = include_source.str();
+            }
+            else
+            {
+                // An empty source name tells shaderc the include failed, content is the error message.
+                p_data->content = "Failed to open file " + include_path;
+            }
+
+            p_data->result = {
+                .source_name = p_data->source_name.c_str(),
+                .source_name_length = p_data->source_name.size(),
+                .content = p_data->content.c_str(),
+                .content_length = p_data->content.size(),
+                .user_data = p_data,
+            };
+
+            return &p_data->result;
+        }
+
+        void ReleaseInclude(shaderc_include_result* p_result) override
+        {
+            delete static_cast<IncludeData*>(p_result->user_data);
+        }
+    };
+};
+
+static std::optional<shaderc_shader_kind> get_shader_kind(const std::string& shader_name)
+{
+    if (shader_name.ends_with(".vert"))
+        return shaderc_vertex_shader;
+    if (shader_name.ends_with(".geom"))
+        return shaderc_geometry_shader;
+    if (shader_name.ends_with(".frag"))
+        return shaderc_fragment_shader;
+    if (shader_name.ends_with(".comp"))
+        return shaderc_compute_shader;
+
+    return std::nullopt;
+}
+
+void ShaderHotReload::start(const std::string& glsl_dir, const std::string& spirv_dir)
+{
+    m_glsl_dir = glsl_dir;
+    m_spirv_dir = spirv_dir;
+
+    m_inotify_fd = inotify_init1(IN_CLOEXEC);
+    m_stop_event_fd = eventfd(0u, EFD_CLOEXEC);
+
+    // Editors either write the file in place or write a temporary and rename it over the original.
+    if (m_inotify_fd < 0 || m_stop_event_fd < 0 || inotify_add_watch(m_inotify_fd, m_glsl_dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+    {
+        std::cerr << "Failed to watch shader directory " << m_glsl_dir << "!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    m_thread = std::thread(&ShaderHotReload::run, this);
+}
+
+void ShaderHotReload::stop()
+{
+    const uint64_t stop_value = 1lu;
+
+    if (write(m_stop_event_fd, &stop_value, sizeof(stop_value)) != sizeof(stop_value))
+        std::cerr << "Failed to signal shader hot reload thread!\n";
+
+    m_thread.join();
+
+    close(m_inotify_fd);
+    close(m_stop_event_fd);
+}
+
+std::vector<std::string> ShaderHotReload::take_reloaded_shaders()
+{
+    std::lock_guard lock(m_reloaded_shader_mutex);
+    return std::exchange(m_reloaded_shader_vec, {});
+}
+
+bool ShaderHotReload::compile(const std::string& shader_name) const
+{
+    const std::string glsl_path = m_glsl_dir + shader_name;
+    const std::string spirv_path = m_spirv_dir + shader_name + ".spv";
+
+    std::ifstream glsl_file(glsl_path);
+
+    if (!glsl_file.is_open())
+    {
+        std::cerr << "Failed to open file " << glsl_path << "!\n";
+        return false;
+    }
+
+    std::stringstream glsl_source;
+    glsl_source << glsl_file.rdbuf();
+
+    // Same target as the vsync_shaders CMake target.
+    shaderc::CompileOptions options;
+    options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_3);
+    options.SetIncluder(std::make_unique<GlslIncluder>(m_glsl_dir));
+
+    const shaderc::Compiler compiler;
+    const shaderc::SpvCompilationResult result = compiler.CompileGlslToSpv(glsl_source.str(), *get_shader_kind(shader_name), glsl_path.c_str(), options);
+
+    if (result.GetCompilationStatus() != shaderc_compilation_status_success)
+    {
+        std::cerr << result.GetErrorMessage();
+        return false;
+    }
+
+    // Written next to the target and renamed over it, so a concurrent load never sees a partial file.
+    const std::string tmp_spirv_path = spirv_path + ".tmp";
+
+    {
+        std::ofstream spirv_file(tmp_spirv_path, std::ios::binary | std::ios::trunc);
+        spirv_file.write(reinterpret_cast<const char*>(result.cbegin()), (result.cend() - result.cbegin()) * sizeof(uint32_t));
+
+        if (!spirv_file.good())
+        {
+            std::cerr << "Failed to write file " << tmp_spirv_path << "!\n";
+            return false;
+        }
+    }
+
+    if (rename(tmp_spirv_path.c_str(), spirv_path.c_str()) != 0)
+    {
+        std::cerr << "Failed to replace file " << spirv_path << "!\n";
+        return false;
+    }
+
+    return true;
+}
+
+void ShaderHotReload::run()
+{
+    pollfd poll_fd_array[2] = {
+        {.fd = m_inotify_fd, .events = POLLIN, .revents = 0},
+        {.fd = m_stop_event_fd, .events = POLLIN, .revents = 0},
+    };
+
+    while (true)
+    {
+        if (poll(poll_fd_array, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            std::cerr << "Shader hot reload stopped, poll failed!\n";
+            return;
+        }
+
+        if (poll_fd_array[1].revents & POLLIN)
+            return;
+
+        alignas(inotify_event) char event_buffer[4096];
+        const ssize_t read_size = read(m_inotify_fd, event_buffer, sizeof(event_buffer));
+
+        if (read_size <= 0)
+            continue;
+
+        // One save can produce several events for the same file, compile each shader once per batch.
+        std::set<std::string> changed_shader_set;
+
+        for (ssize_t offset = 0; offset < read_size;)
+        {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(event_buffer + offset);
+            offset += sizeof(inotify_event) + event->len;
+
+            if (event->len > 0u && get_shader_kind(event->name).has_value())
+                changed_shader_set.insert(event->name);
+        }
+
+        for (const std::string& shader_name : changed_shader_set)
+        {
+            if (!compile(shader_name))
+            {
+                std::cerr << "Shader " << shader_name << " failed to compile, keeping the previous version.\n";
+                continue;
+            }
+
+            std::cout << "Shader " << shader_name << " reloaded.\n";
+
+            std::lock_guard lock(m_reloaded_shader_mutex);
+            m_reloaded_shader_vec.push_back(m_spirv_dir + shader_name);
+        }
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef SHADER_HOT_RELOAD_HPP
+#define SHADER_HOT_RELOAD_HPP
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Watches the GLSL directory with inotify and compiles changed shaders with shaderc on its own thread.
+// The SPIR-V replaces the file in the SPIR-V directory, so the next compile of a program that uses
+// the shader picks it up. A shader that fails to compile is reported and the previous SPIR-V stays in place.
+struct ShaderHotReload
+{
+private:
+    std::thread m_thread;
+    int m_inotify_fd {-1};
+    int m_stop_event_fd {-1};
+
+    std::string m_glsl_dir;
+    std::string m_spirv_dir;
+
+    std::mutex m_reloaded_shader_mutex;
+    std::vector<std::string> m_reloaded_shader_vec;
+
+    void run();
+    bool compile(const std::string& shader_name) const;
+
+public:
+    void start(const std::string& glsl_dir, const std::string& spirv_dir);
+    void stop();
+
+    // Shaders recompiled since the last call, as spirv_dir + name (the paths given to set_shaders).
+    std::vector<std::string> take_reloaded_shaders();
+};
+
+#endif
@@ -0,0 +1,225 @@
+#include "ShaderModuleCache.hpp"
+#include "Hash.hpp"
+#include "ShaderArchive.hpp"
+#include "vk_core.hpp"
+
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    struct ShaderModuleEntry
+    {
+        VkShaderModule vk_handle_shader_module;
+        uint32_t ref_count;
+    };
+
+    struct SpirvFileStamp
+    {
+        int64_t mtime_ns;
+        int64_t size;
+        uint64_t content_hash;
+    };
+
+    std::mutex cache_mutex;
+    std::unordered_map<uint64_t, ShaderModuleEntry> module_map;           // content hash -> module
+    std::unordered_map<VkShaderModule, uint64_t> module_content_hash_map; // module -> content hash
+    std::unordered_map<std::string, SpirvFileStamp> spirv_file_stamp_map;
+
+    struct MappedFile
+    {
+        const void* data;
+        size_t size;
+    };
+
+    MappedFile map_file(const std::string& filepath, struct stat& file_stat)
+    {
+        const int fd = open(filepath.c_str(), O_RDONLY);
+
+        if (fd < 0 || fstat(fd, &file_stat) != 0 || file_stat.st_size == 0)
+        {
+            std::cerr << "Failed to open file " << filepath << "!\n";
+            exit(EXIT_FAILURE);
+        }
+
+        void* data = mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+        // The mapping keeps the file referenced, the descriptor is not needed anymore.
+        close(fd);
+
+        if (data == MAP_FAILED)
+        {
+            std::cerr << "Failed to map file " << filepath << "!\n";
+            exit(EXIT_FAILURE);
+        }
+
+        return {data, static_cast<size_t>(file_stat.st_size)};
+    }
+
+    int64_t get_mtime_ns(const struct stat& file_stat)
+    {
+        return static_cast<int64_t>(file_stat.st_mtim.tv_sec) * 1000000000 + file_stat.st_mtim.tv_nsec;
+    }
+
+    // Stamp of the file if it did not change since it was last hashed.
+    const SpirvFileStamp* find_current_stamp(const std::string& spirv_path)
+    {
+        const auto it = spirv_file_stamp_map.find(spirv_path);
+        struct stat file_stat;
+
+        if (it == spirv_file_stamp_map.end() || stat(spirv_path.c_str(), &file_stat) != 0)
+            return nullptr;
+
+        const SpirvFileStamp& stamp = it->second;
+
+        if (stamp.mtime_ns != get_mtime_ns(file_stat) || stamp.size != file_stat.st_size)
+            return nullptr;
+
+        return &stamp;
+    }
+
+    uint64_t hash_and_stamp(const std::string& spirv_path, const MappedFile& spirv_file, const struct stat& file_stat)
+    {
+        Hasher hasher;
+        hasher.add(spirv_file.data, spirv_file.size);
+
+        spirv_file_stamp_map[spirv_path] = {
+            .mtime_ns = get_mtime_ns(file_stat),
+            .size = file_stat.st_size,
+            .content_hash = hasher.value,
+        };
+
+        return hasher.value;
+    }
+
+    VkShaderModule reference_module(uint64_t content_hash)
+    {
+        auto& entry = module_map.at(content_hash);
+        entry.ref_count++;
+        return entry.vk_handle_shader_module;
+    }
+
+    void create_module(uint64_t content_hash, const void* code, size_t code_size)
+    {
+        const VkShaderModuleCreateInfo create_info {
+            .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0x0,
+            .codeSize = code_size,
+            .pCode = static_cast<const uint32_t*>(code),
+        };
+
+        const VkShaderModule vk_handle_shader_module = vk_core::create_shader_module(create_info);
+
+        module_map[content_hash] = {vk_handle_shader_module, 0u};
+        module_content_hash_map[vk_handle_shader_module] = content_hash;
+    }
+};
+
+VkShaderModule shader_module_cache::acquire(const std::string& spirv_path)
+{
+    std::lock_guard lock(cache_mutex);
+
+    // Archived modules are hashed by the packer and stay mapped.
+    if (const SpirvBlob* blob = shader_archive::find(spirv_path); blob != nullptr)
+    {
+        if (!module_map.contains(blob->content_hash))
+            create_module(blob->content_hash, blob->code, blob->size);
+
+        return reference_module(blob->content_hash);
+    }
+
+    // Unchanged file whose module is still cached - no need to touch the contents.
+    if (const SpirvFileStamp* stamp = find_current_stamp(spirv_path); stamp != nullptr && module_map.contains(stamp->content_hash))
+        return reference_module(stamp->content_hash);
+
+    struct stat file_stat;
+    const MappedFile spirv_file = map_file(spirv_path, file_stat);
+    const uint64_t content_hash = hash_and_stamp(spirv_path, spirv_file, file_stat);
+
+    if (!module_map.contains(content_hash))
+        create_module(content_hash, spirv_file.data, spirv_file.size);
+
+    munmap(const_cast<void*>(spirv_file.data), spirv_file.size);
+
+    return reference_module(content_hash);
+}
+
+uint64_t shader_module_cache::get_content_hash(const std::string& spirv_path)
+{
+    if (const SpirvBlob* blob = shader_archive::find(spirv_path); blob != nullptr)
+        return blob->content_hash;
+
+    std::lock_guard lock(cache_mutex);
+
+    if (const SpirvFileStamp* stamp = find_current_stamp(spirv_path); stamp != nullptr)
+        return stamp->content_hash;
+
+    struct stat file_stat;
+    const MappedFile spirv_file = map_file(spirv_path, file_stat);
+    const uint64_t content_hash = hash_and_stamp(spirv_path, spirv_file, file_stat);
+
+    munmap(const_cast<void*>(spirv_file.data), spirv_file.size);
+
+    return content_hash;
+}
+
+void shader_module_cache::release(VkShaderModule vk_handle_shader_module)
+{
+    std::lock_guard lock(cache_mutex);
+
+    auto& entry = module_map.at(module_content_hash_map.at(vk_handle_shader_module));
+
+    if (entry.ref_count == 0u)
+    {
+        std::cerr << "Shader module released more often than acquired!\n";
+        return;
+    }
+
+    entry.ref_count--;
+}
+
+void shader_module_cache::trim()
+{
+    std::lock_guard lock(cache_mutex);
+
+    std::erase_if(module_map, [](const auto& key_entry) {
+        const ShaderModuleEntry& entry = key_entry.second;
+
+        if (entry.ref_count > 0u)
+            return false;
+
+        module_content_hash_map.erase(entry.vk_handle_shader_module);
+        vk_core::destroy_shader_module(entry.vk_handle_shader_module);
+        return true;
+    });
+}
+
+void shader_module_cache::destroy()
+{
+    std::lock_guard lock(cache_mutex);
+
+    for (const auto& [content_hash, entry] : module_map)
+    {
+        if (entry.ref_count > 0u)
+            std::cerr << "Destroying shader module with " << entry.ref_count << " references!\n";
+
+        vk_core::destroy_shader_module(entry.vk_handle_shader_module);
+    }
+
+    module_map.clear();
+    module_content_hash_map.clear();
+    spirv_file_stamp_map.clear();
+}
+
+uint32_t shader_module_cache::get_module_count()
+{
+    std::lock_guard lock(cache_mutex);
+    return static_cast<uint32_t>(module_map.size());
+}
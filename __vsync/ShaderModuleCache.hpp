@@ -0,0 +1,32 @@
+#ifndef SHADER_MODULE_CACHE_HPP
+#define SHADER_MODULE_CACHE_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <string>
+#include <inttypes.h>
+
+// Shader modules keyed by a hash of their SPIR-V, so pipelines that share a shader share one module.
+// SPIR-V files are mmapped and handed to the driver straight from the mapping. A file is only mapped
+// and hashed again when its size or modification time changed. Modules in the open shader_archive are
+// used instead of their files.
+//
+// acquire() references a module, release() drops the reference. Unreferenced modules stay cached
+// for the next pipeline until trim() or destroy(). Pipelines release their modules once created, so
+// call trim() when a batch of compiles is done, e.g. after a hot reload, or replaced SPIR-V piles up.
+namespace shader_module_cache
+{
+    VkShaderModule acquire(const std::string& spirv_path);
+    void release(VkShaderModule vk_handle_shader_module);
+
+    // Hash of the SPIR-V the next acquire of spirv_path would use.
+    uint64_t get_content_hash(const std::string& spirv_path);
+
+    // Destroys modules that are not referenced.
+    void trim();
+    void destroy();
+
+    uint32_t get_module_count();
+};
+
+#endif
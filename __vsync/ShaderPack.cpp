@@ -0,0 +1,106 @@
+// vsync_shader_pack <archive> <spirv files...>
+//
+// Build tool, packs SPIR-V files into the archive shader_archive maps at runtime. Files are stored under
+// the names they are given as, relative to the SPIR-V directory.
+#include "ShaderArchive.hpp"
+#include "Hash.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    std::vector<char> read_file(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+
+        if (!file.is_open())
+        {
+            std::cerr << "Failed to open file " << path << "!\n";
+            exit(EXIT_FAILURE);
+        }
+
+        std::vector<char> data(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(data.data(), data.size());
+
+        if (data.empty() || data.size() % sizeof(uint32_t) != 0u)
+        {
+            std::cerr << path << " is not SPIR-V!\n";
+            exit(EXIT_FAILURE);
+        }
+
+        return data;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: vsync_shader_pack <archive> <spirv files...>\n";
+        return EXIT_FAILURE;
+    }
+
+    // Sorted so the archive only changes when a module does.
+    std::vector<std::string> name_vec(argv + 2, argv + argc);
+    std::sort(name_vec.begin(), name_vec.end());
+
+    std::vector<ShaderArchiveEntry> entry_vec;
+    std::string name_table;
+    std::vector<std::vector<char>> data_vec;
+
+    for (const std::string& name : name_vec)
+    {
+        std::vector<char>& data = data_vec.emplace_back(read_file(name));
+
+        Hasher hasher;
+        hasher.add(data.data(), data.size());
+
+        entry_vec.push_back({
+            .content_hash = hasher.value,
+            .data_offset = 0u,
+            .data_size = data.size(),
+            .name_offset = static_cast<uint32_t>(name_table.size()),
+            .name_size = static_cast<uint32_t>(name.size()),
+        });
+
+        name_table += name;
+    }
+
+    // Module data starts 4 byte aligned after the name table, module sizes are multiples of 4.
+    name_table.resize((name_table.size() + sizeof(uint32_t) - 1u) / sizeof(uint32_t) * sizeof(uint32_t), '\0');
+
+    uint64_t data_offset = sizeof(ShaderArchiveHeader) + entry_vec.size() * sizeof(ShaderArchiveEntry) + name_table.size();
+
+    for (ShaderArchiveEntry& entry : entry_vec)
+    {
+        entry.data_offset = data_offset;
+        data_offset += entry.data_size;
+    }
+
+    const ShaderArchiveHeader header {
+        .magic = shader_archive_magic,
+        .version = shader_archive_version,
+        .entry_count = static_cast<uint32_t>(entry_vec.size()),
+        .name_table_size = static_cast<uint32_t>(name_table.size()),
+    };
+
+    std::ofstream file(argv[1], std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(entry_vec.data()), entry_vec.size() * sizeof(ShaderArchiveEntry));
+    file.write(name_table.data(), name_table.size());
+
+    for (const std::vector<char>& data : data_vec)
+        file.write(data.data(), data.size());
+
+    if (!file.good())
+    {
+        std::cerr << "Failed to write shader archive " << argv[1] << "!\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,626 @@
+#include "SpirvReflection.hpp"
+#include "ShaderArchive.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <tuple>
+#include <unordered_map>
+
+namespace
+{
+    constexpr uint32_t spirv_magic = 0x07230203;
+
+    enum Op : uint32_t
+    {
+        OpEntryPoint = 15,
+        OpExecutionMode = 16,
+        OpTypeBool = 20,
+        OpTypeInt = 21,
+        OpTypeFloat = 22,
+        OpTypeVector = 23,
+        OpTypeMatrix = 24,
+        OpTypeImage = 25,
+        OpTypeSampler = 26,
+        OpTypeSampledImage = 27,
+        OpTypeArray = 28,
+        OpTypeRuntimeArray = 29,
+        OpTypeStruct = 30,
+        OpTypePointer = 32,
+        OpConstant = 43,
+        OpSpecConstant = 50,
+        OpSpecConstantOp = 52,
+        OpVariable = 59,
+        OpDecorate = 71,
+        OpMemberDecorate = 72,
+        OpExecutionModeId = 331,
+        OpTypeAccelerationStructureKHR = 5341,
+    };
+
+    enum Decoration : uint32_t
+    {
+        DecorationSpecId = 1,
+        DecorationBlock = 2,
+        DecorationBufferBlock = 3,
+        DecorationArrayStride = 6,
+        DecorationMatrixStride = 7,
+        DecorationBuiltIn = 11,
+        DecorationLocation = 30,
+        DecorationBinding = 33,
+        DecorationDescriptorSet = 34,
+        DecorationOffset = 35,
+    };
+
+    enum StorageClass : uint32_t
+    {
+        StorageClassUniformConstant = 0,
+        StorageClassInput = 1,
+        StorageClassUniform = 2,
+        StorageClassPushConstant = 9,
+        StorageClassStorageBuffer = 12,
+    };
+
+    constexpr uint32_t ExecutionModeLocalSize = 17;
+    constexpr uint32_t ExecutionModeLocalSizeId = 38;
+    constexpr uint32_t DimBuffer = 5;
+    constexpr uint32_t DimSubpassData = 6;
+
+    constexpr uint32_t not_decorated = UINT32_MAX;
+
+    struct IdInfo
+    {
+        // Type and constant definitions point at their instruction.
+        const uint32_t* instruction = nullptr;
+
+        uint32_t desc_set = not_decorated;
+        uint32_t binding = not_decorated;
+        uint32_t location = not_decorated;
+        uint32_t array_stride = 0u;
+        uint32_t spec_id = not_decorated;
+        bool is_builtin = false;
+        bool is_block = false;
+        bool is_buffer_block = false;
+    };
+
+    struct MemberInfo
+    {
+        uint32_t offset = 0u;
+        uint32_t matrix_stride = 0u;
+    };
+
+    struct Variable
+    {
+        uint32_t id;
+        uint32_t pointer_type_id;
+        uint32_t storage_class;
+    };
+
+    struct SpirvModule
+    {
+        std::vector<uint32_t> word_vec;
+        std::vector<IdInfo> id_info_vec;
+        std::unordered_map<uint64_t, MemberInfo> member_info_map; // struct id << 32 | member index
+        std::vector<Variable> variable_vec;
+        VkShaderStageFlagBits stage = VK_SHADER_STAGE_FLAG_BITS_MAX_ENUM;
+        std::array<uint32_t, 3> workgroup_size {0u, 0u, 0u};
+        std::array<uint32_t, 3> workgroup_size_id_array {0u, 0u, 0u}; // LocalSizeId operands, resolved after parsing
+        const VkSpecializationInfo* specialization_info = nullptr;      // values of the variant being reflected
+
+        const uint32_t* get_instruction(uint32_t id) const { return id_info_vec.at(id).instruction; }
+        uint32_t get_opcode(uint32_t id) const { return get_instruction(id)[0] & 0xFFFF; }
+
+        MemberInfo get_member_info(uint32_t struct_id, uint32_t member_idx) const
+        {
+            const auto it = member_info_map.find((static_cast<uint64_t>(struct_id) << 32) | member_idx);
+            return (it != member_info_map.end()) ? it->second : MemberInfo{};
+        }
+    };
+
+    [[noreturn]] void exit_invalid_spirv(const std::string& spirv_path, const char* reason)
+    {
+        std::cerr << "Failed to reflect " << spirv_path << ": " << reason << "!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    std::vector<uint32_t> read_spirv(const std::string& spirv_path)
+    {
+        if (const SpirvBlob* blob = shader_archive::find(spirv_path); blob != nullptr)
+            return std::vector<uint32_t>(blob->code, blob->code + blob->size / sizeof(uint32_t));
+
+        std::ifstream file(spirv_path, std::ios::binary | std::ios::ate);
+
+        if (!file.is_open())
+        {
+            std::cerr << "Failed to open file " << spirv_path << "!\n";
+            exit(EXIT_FAILURE);
+        }
+
+        std::vector<uint32_t> word_vec(static_cast<size_t>(file.tellg()) / sizeof(uint32_t));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(word_vec.data()), word_vec.size() * sizeof(uint32_t));
+
+        return word_vec;
+    }
+
+    VkShaderStageFlagBits get_stage(uint32_t execution_model)
+    {
+        switch (execution_model)
+        {
+            case 0: return VK_SHADER_STAGE_VERTEX_BIT;
+            case 1: return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+            case 2: return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+            case 3: return VK_SHADER_STAGE_GEOMETRY_BIT;
+            case 4: return VK_SHADER_STAGE_FRAGMENT_BIT;
+            case 5: return VK_SHADER_STAGE_COMPUTE_BIT;
+            default: return VK_SHADER_STAGE_FLAG_BITS_MAX_ENUM;
+        }
+    }
+
+    SpirvModule parse(const std::string& spirv_path, const VkSpecializationInfo* specialization_info)
+    {
+        SpirvModule spirv;
+        spirv.word_vec = read_spirv(spirv_path);
+        spirv.specialization_info = specialization_info;
+
+        const std::vector<uint32_t>& word_vec = spirv.word_vec;
+
+        if (word_vec.size() < 5 || word_vec[0] != spirv_magic)
+            exit_invalid_spirv(spirv_path, "not a SPIR-V spirv");
+
+        spirv.id_info_vec.resize(word_vec[3]);
+
+        for (size_t i = 5; i < word_vec.size();)
+        {
+            const uint32_t* instruction = &word_vec[i];
+            const uint32_t opcode = instruction[0] & 0xFFFF;
+            const uint32_t word_count = instruction[0] >> 16;
+
+            if (word_count == 0 || i + word_count > word_vec.size())
+                exit_invalid_spirv(spirv_path, "truncated instruction");
+
+            i += word_count;
+
+            switch (opcode)
+            {
+                case OpEntryPoint:
+                    // Only the first entry point is reflected, the shaders have a single "main".
+                    if (spirv.stage == VK_SHADER_STAGE_FLAG_BITS_MAX_ENUM)
+                        spirv.stage = get_stage(instruction[1]);
+                    break;
+
+                case OpExecutionMode:
+                    if (instruction[2] == ExecutionModeLocalSize)
+                        spirv.workgroup_size = {instruction[3], instruction[4], instruction[5]};
+                    break;
+
+                case OpExecutionModeId:
+                    if (instruction[2] == ExecutionModeLocalSizeId)
+                        spirv.workgroup_size_id_array = {instruction[3], instruction[4], instruction[5]};
+                    break;
+
+                case OpTypeBool:
+                case OpTypeInt:
+                case OpTypeFloat:
+                case OpTypeVector:
+                case OpTypeMatrix:
+                case OpTypeImage:
+                case OpTypeSampler:
+                case OpTypeSampledImage:
+                case OpTypeArray:
+                case OpTypeRuntimeArray:
+                case OpTypeStruct:
+                case OpTypePointer:
+                case OpTypeAccelerationStructureKHR:
+                    spirv.id_info_vec.at(instruction[1]).instruction = instruction;
+                    break;
+
+                case OpConstant:
+                case OpSpecConstant:
+                case OpSpecConstantOp:
+                    spirv.id_info_vec.at(instruction[2]).instruction = instruction;
+                    break;
+
+                case OpVariable:
+                    spirv.variable_vec.push_back({instruction[2], instruction[1], instruction[3]});
+                    break;
+
+                case OpDecorate:
+                {
+                    IdInfo& info = spirv.id_info_vec.at(instruction[1]);
+
+                    switch (instruction[2])
+                    {
+                        case DecorationBlock: info.is_block = true; break;
+                        case DecorationBufferBlock: info.is_buffer_block = true; break;
+                        case DecorationArrayStride: info.array_stride = instruction[3]; break;
+                        case DecorationSpecId: info.spec_id = instruction[3]; break;
+                        case DecorationBuiltIn: info.is_builtin = true; break;
+                        case DecorationLocation: info.location = instruction[3]; break;
+                        case DecorationBinding: info.binding = instruction[3]; break;
+                        case DecorationDescriptorSet: info.desc_set = instruction[3]; break;
+                        default: break;
+                    }
+                    break;
+                }
+
+                case OpMemberDecorate:
+                {
+                    MemberInfo& info = spirv.member_info_map[(static_cast<uint64_t>(instruction[1]) << 32) | instruction[2]];
+
+                    if (instruction[3] == DecorationOffset)
+                        info.offset = instruction[4];
+                    else if (instruction[3] == DecorationMatrixStride)
+                        info.matrix_stride = instruction[4];
+                    break;
+                }
+
+                default:
+                    break;
+            }
+        }
+
+        // Execution modes come before the constants they reference. Sizes from specialization constants
+        // stay unknown (0) and have to be set with set_workgroup_size.
+        if (spirv.workgroup_size_id_array != std::array<uint32_t, 3>{0u, 0u, 0u})
+        {
+            std::array<uint32_t, 3> workgroup_size {0u, 0u, 0u};
+
+            for (uint32_t i = 0; i < 3u; i++)
+            {
+                const uint32_t* constant_instruction = spirv.id_info_vec.at(spirv.workgroup_size_id_array[i]).instruction;
+
+                if (constant_instruction == nullptr || (constant_instruction[0] & 0xFFFF) != OpConstant)
+                {
+                    workgroup_size = {0u, 0u, 0u};
+                    break;
+                }
+
+                workgroup_size[i] = constant_instruction[3];
+            }
+
+            spirv.workgroup_size = workgroup_size;
+        }
+
+        return spirv;
+    }
+
+    // Value the specialization info sets for the constant, its default value if the info does not set it.
+    uint32_t get_spec_constant_value(const SpirvModule& spirv, uint32_t id)
+    {
+        const uint32_t spec_id = spirv.id_info_vec.at(id).spec_id;
+        const VkSpecializationInfo* specialization_info = spirv.specialization_info;
+
+        for (uint32_t i = 0; specialization_info != nullptr && i < specialization_info->mapEntryCount; i++)
+        {
+            const VkSpecializationMapEntry& map_entry = specialization_info->pMapEntries[i];
+
+            if (map_entry.constantID != spec_id)
+                continue;
+
+            uint32_t value = 0u;
+            std::memcpy(&value, static_cast<const uint8_t*>(specialization_info->pData) + map_entry.offset, std::min(map_entry.size, sizeof(uint32_t)));
+            return value;
+        }
+
+        return spirv.get_instruction(id)[3];
+    }
+
+    // Length of an OpTypeArray. Specialization constant lengths take the value of the variant being
+    // reflected, so the layout matches the specialized shader.
+    uint32_t get_array_length(const SpirvModule& spirv, uint32_t length_id)
+    {
+        const uint32_t* instruction = spirv.get_instruction(length_id);
+
+        if (instruction != nullptr && (instruction[0] & 0xFFFF) == OpConstant)
+            return instruction[3];
+
+        if (instruction != nullptr && (instruction[0] & 0xFFFF) == OpSpecConstant)
+            return get_spec_constant_value(spirv, length_id);
+
+        std::cerr << "Failed to reflect a spec-constant array length, only constants and plain spec constants are supported!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    // Size of a type in a block with explicit layout.
+    uint32_t get_type_size(const SpirvModule& spirv, uint32_t type_id, uint32_t matrix_stride = 0u)
+    {
+        const uint32_t* instruction = spirv.get_instruction(type_id);
+
+        switch (instruction[0] & 0xFFFF)
+        {
+            case OpTypeBool:
+                return 4u;
+            case OpTypeInt:
+            case OpTypeFloat:
+                return instruction[2] / 8u;
+            case OpTypeVector:
+                return instruction[3] * get_type_size(spirv, instruction[2]);
+            case OpTypeMatrix:
+                return instruction[3] * ((matrix_stride != 0u) ? matrix_stride : get_type_size(spirv, instruction[2]));
+            case OpTypeArray:
+            {
+                const uint32_t length = get_array_length(spirv, instruction[3]);
+                const uint32_t array_stride = spirv.id_info_vec[type_id].array_stride;
+                return length * ((array_stride != 0u) ? array_stride : get_type_size(spirv, instruction[2]));
+            }
+            case OpTypeStruct:
+            {
+                const uint32_t member_count = (instruction[0] >> 16) - 2;
+                uint32_t size = 0u;
+
+                for (uint32_t i = 0; i < member_count; i++)
+                {
+                    const MemberInfo member_info = spirv.get_member_info(type_id, i);
+                    size = std::max(size, member_info.offset + get_type_size(spirv, instruction[2 + i], member_info.matrix_stride));
+                }
+
+                return size;
+            }
+            default:
+                return 0u;
+        }
+    }
+
+    VkDescriptorType get_descriptor_type(const SpirvModule& spirv, uint32_t type_id, uint32_t storage_class)
+    {
+        const IdInfo& info = spirv.id_info_vec[type_id];
+        const uint32_t* instruction = info.instruction;
+
+        if (storage_class == StorageClassStorageBuffer)
+            return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+
+        if (storage_class == StorageClassUniform)
+            return info.is_buffer_block ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+
+        switch (instruction[0] & 0xFFFF)
+        {
+            case OpTypeSampler:
+                return VK_DESCRIPTOR_TYPE_SAMPLER;
+            case OpTypeSampledImage:
+                return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            case OpTypeAccelerationStructureKHR:
+                return VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
+            case OpTypeImage:
+            {
+                const uint32_t dim = instruction[3];
+                const uint32_t sampled = instruction[7];
+
+                if (dim == DimSubpassData)
+                    return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+                if (dim == DimBuffer)
+                    return (sampled == 2u) ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+
+                return (sampled == 2u) ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+            }
+            default:
+                return VK_DESCRIPTOR_TYPE_MAX_ENUM;
+        }
+    }
+
+    // 16, 32 and 64 bit scalars and vectors, in the order R, RG, RGB, RGBA.
+    VkFormat get_vertex_format(const SpirvModule& spirv, uint32_t type_id)
+    {
+        const uint32_t* instruction = spirv.get_instruction(type_id);
+        uint32_t component_count = 1u;
+
+        if ((instruction[0] & 0xFFFF) == OpTypeVector)
+        {
+            component_count = instruction[3];
+            instruction = spirv.get_instruction(instruction[2]);
+        }
+
+        const uint32_t opcode = instruction[0] & 0xFFFF;
+        const uint32_t width = instruction[2];
+        const bool is_signed = (opcode == OpTypeInt) && instruction[3] == 1u;
+
+        static constexpr VkFormat float_format_array[3][4] = {
+            {VK_FORMAT_R16_SFLOAT, VK_FORMAT_R16G16_SFLOAT, VK_FORMAT_R16G16B16_SFLOAT, VK_FORMAT_R16G16B16A16_SFLOAT},
+            {VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT},
+            {VK_FORMAT_R64_SFLOAT, VK_FORMAT_R64G64_SFLOAT, VK_FORMAT_R64G64B64_SFLOAT, VK_FORMAT_R64G64B64A64_SFLOAT},
+        };
+        static constexpr VkFormat sint_format_array[3][4] = {
+            {VK_FORMAT_R16_SINT, VK_FORMAT_R16G16_SINT, VK_FORMAT_R16G16B16_SINT, VK_FORMAT_R16G16B16A16_SINT},
+            {VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT},
+            {VK_FORMAT_R64_SINT, VK_FORMAT_R64G64_SINT, VK_FORMAT_R64G64B64_SINT, VK_FORMAT_R64G64B64A64_SINT},
+        };
+        static constexpr VkFormat uint_format_array[3][4] = {
+            {VK_FORMAT_R16_UINT, VK_FORMAT_R16G16_UINT, VK_FORMAT_R16G16B16_UINT, VK_FORMAT_R16G16B16A16_UINT},
+            {VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT},
+            {VK_FORMAT_R64_UINT, VK_FORMAT_R64G64_UINT, VK_FORMAT_R64G64B64_UINT, VK_FORMAT_R64G64B64A64_UINT},
+        };
+
+        const uint32_t width_idx = (width == 16u) ? 0u : (width == 32u) ? 1u : (width == 64u) ? 2u : UINT32_MAX;
+
+        if ((opcode != OpTypeInt && opcode != OpTypeFloat) || width_idx == UINT32_MAX || component_count > 4u)
+            return VK_FORMAT_UNDEFINED;
+
+        if (opcode == OpTypeFloat)
+            return float_format_array[width_idx][component_count - 1];
+
+        return is_signed ? sint_format_array[width_idx][component_count - 1] : uint_format_array[width_idx][component_count - 1];
+    }
+
+    void add_descriptor_binding(ShaderInterface& shader_interface, uint32_t desc_set, const VkDescriptorSetLayoutBinding& binding, const std::string& spirv_path)
+    {
+        std::vector<VkDescriptorSetLayoutBinding>& binding_vec = shader_interface.desc_set_binding_map[desc_set];
+
+        const auto it = std::find_if(binding_vec.begin(), binding_vec.end(), [&binding](const VkDescriptorSetLayoutBinding& other) {
+            return other.binding == binding.binding;
+        });
+
+        if (it == binding_vec.end())
+        {
+            binding_vec.insert(std::upper_bound(binding_vec.begin(), binding_vec.end(), binding, [](const auto& lhs, const auto& rhs) {
+                return lhs.binding < rhs.binding;
+            }), binding);
+            return;
+        }
+
+        if (it->descriptorType != binding.descriptorType || it->descriptorCount != binding.descriptorCount)
+            exit_invalid_spirv(spirv_path, "descriptor binding declared differently by another stage");
+
+        it->stageFlags |= binding.stageFlags;
+    }
+
+    void add_push_constant_range(ShaderInterface& shader_interface, const VkPushConstantRange& range)
+    {
+        if (shader_interface.push_constant_range_vec.empty())
+        {
+            shader_interface.push_constant_range_vec.push_back(range);
+            return;
+        }
+
+        VkPushConstantRange& merged_range = shader_interface.push_constant_range_vec.front();
+        const uint32_t end = std::max(merged_range.offset + merged_range.size, range.offset + range.size);
+
+        merged_range.stageFlags |= range.stageFlags;
+        merged_range.offset = std::min(merged_range.offset, range.offset);
+        merged_range.size = end - merged_range.offset;
+    }
+};
+
+ShaderInterface spirv_reflection::reflect(const std::string& spirv_path, const VkSpecializationInfo* specialization_info)
+{
+    const SpirvModule spirv = parse(spirv_path, specialization_info);
+
+    ShaderInterface shader_interface;
+    shader_interface.workgroup_size = spirv.workgroup_size;
+
+    std::vector<std::tuple<uint32_t, VkFormat, uint32_t>> vertex_input_vec; // location, format, size
+
+    for (const Variable& variable : spirv.variable_vec)
+    {
+        const IdInfo& variable_info = spirv.id_info_vec.at(variable.id);
+        uint32_t type_id = spirv.get_instruction(variable.pointer_type_id)[3];
+
+        switch (variable.storage_class)
+        {
+            case StorageClassUniformConstant:
+            case StorageClassUniform:
+            case StorageClassStorageBuffer:
+            {
+                uint32_t descriptor_count = 1u;
+
+                if (spirv.get_opcode(type_id) == OpTypeArray)
+                {
+                    descriptor_count = get_array_length(spirv, spirv.get_instruction(type_id)[3]);
+                    type_id = spirv.get_instruction(type_id)[2];
+                }
+                else if (spirv.get_opcode(type_id) == OpTypeRuntimeArray)
+                {
+                    descriptor_count = 0u;
+                    type_id = spirv.get_instruction(type_id)[2];
+                }
+
+                const VkDescriptorType descriptor_type = get_descriptor_type(spirv, type_id, variable.storage_class);
+
+                if (descriptor_type == VK_DESCRIPTOR_TYPE_MAX_ENUM || variable_info.binding == not_decorated)
+                    exit_invalid_spirv(spirv_path, "unsupported resource");
+
+                add_descriptor_binding(shader_interface, (variable_info.desc_set != not_decorated) ? variable_info.desc_set : 0u, {
+                    .binding = variable_info.binding,
+                    .descriptorType = descriptor_type,
+                    .descriptorCount = descriptor_count,
+                    .stageFlags = static_cast<VkShaderStageFlags>(spirv.stage),
+                    .pImmutableSamplers = nullptr,
+                }, spirv_path);
+                break;
+            }
+
+            case StorageClassPushConstant:
+            {
+                const uint32_t* instruction = spirv.get_instruction(type_id);
+                const uint32_t member_count = (instruction[0] >> 16) - 2;
+                uint32_t offset = UINT32_MAX;
+
+                for (uint32_t i = 0; i < member_count; i++)
+                    offset = std::min(offset, spirv.get_member_info(type_id, i).offset);
+
+                if (member_count > 0u)
+                {
+                    add_push_constant_range(shader_interface, {
+                        .stageFlags = static_cast<VkShaderStageFlags>(spirv.stage),
+                        .offset = offset,
+                        .size = get_type_size(spirv, type_id) - offset,
+                    });
+                }
+                break;
+            }
+
+            case StorageClassInput:
+            {
+                if (spirv.stage != VK_SHADER_STAGE_VERTEX_BIT || variable_info.is_builtin || spirv.id_info_vec.at(type_id).is_block)
+                    break;
+
+                const VkFormat format = get_vertex_format(spirv, type_id);
+
+                if (format == VK_FORMAT_UNDEFINED || variable_info.location == not_decorated)
+                    exit_invalid_spirv(spirv_path, "unsupported vertex input");
+
+                vertex_input_vec.push_back({variable_info.location, format, get_type_size(spirv, type_id)});
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
+    std::sort(vertex_input_vec.begin(), vertex_input_vec.end());
+
+    uint32_t vertex_stride = 0u;
+
+    for (const auto& [location, format, size] : vertex_input_vec)
+    {
+        shader_interface.vertex_attrib_desc_vec.push_back({
+            .location = location,
+            .binding = 0u,
+            .format = format,
+            .offset = vertex_stride,
+        });
+
+        vertex_stride += size;
+    }
+
+    if (vertex_stride > 0u)
+    {
+        shader_interface.vertex_binding_desc_vec.push_back({
+            .binding = 0u,
+            .stride = vertex_stride,
+            .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+        });
+    }
+
+    return shader_interface;
+}
+
+ShaderInterface spirv_reflection::reflect_program(const std::vector<std::string>& spirv_path_vec, const VkSpecializationInfo* specialization_info)
+{
+    ShaderInterface program_interface;
+
+    for (const std::string& spirv_path : spirv_path_vec)
+    {
+        ShaderInterface shader_interface = reflect(spirv_path, specialization_info);
+
+        for (const auto& [desc_set, binding_vec] : shader_interface.desc_set_binding_map)
+        {
+            for (const VkDescriptorSetLayoutBinding& binding : binding_vec)
+                add_descriptor_binding(program_interface, desc_set, binding, spirv_path);
+        }
+
+        for (const VkPushConstantRange& range : shader_interface.push_constant_range_vec)
+            add_push_constant_range(program_interface, range);
+
+        if (!shader_interface.vertex_attrib_desc_vec.empty())
+        {
+            program_interface.vertex_binding_desc_vec = std::move(shader_interface.vertex_binding_desc_vec);
+            program_interface.vertex_attrib_desc_vec = std::move(shader_interface.vertex_attrib_desc_vec);
+        }
+
+        if (shader_interface.workgroup_size != std::array<uint32_t, 3>{0u, 0u, 0u})
+            program_interface.workgroup_size = shader_interface.workgroup_size;
+    }
+
+    return program_interface;
+}
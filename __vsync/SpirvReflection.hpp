@@ -0,0 +1,45 @@
+#ifndef SPIRV_REFLECTION_HPP
+#define SPIRV_REFLECTION_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <map>
+#include <string>
+#include <vector>
+#include <inttypes.h>
+
+// Resources and inputs the shaders of a program declare.
+struct ShaderInterface
+{
+    // Set index -> bindings sorted by binding index. A binding used by several stages has all of them in stageFlags.
+    // Runtime arrays have a descriptorCount of 0, they index the bindless table.
+    std::map<uint32_t, std::vector<VkDescriptorSetLayoutBinding>> desc_set_binding_map;
+
+    // At most one range, covering the push constant blocks of all stages.
+    std::vector<VkPushConstantRange> push_constant_range_vec;
+
+    // Not reflected, the set a program pushes with VK_KHR_push_descriptor (UINT32_MAX for none), see
+    // Compiler_GraphicsProgram::set_push_descriptor_set.
+    uint32_t push_desc_set {UINT32_MAX};
+
+    // Vertex shader inputs in location order, packed into binding 0.
+    std::vector<VkVertexInputBindingDescription> vertex_binding_desc_vec;
+    std::vector<VkVertexInputAttributeDescription> vertex_attrib_desc_vec;
+
+    // LocalSize of a compute shader, zero if it is not a compute shader or the size is a specialization constant.
+    std::array<uint32_t, 3> workgroup_size {0u, 0u, 0u};
+};
+
+// Minimal SPIR-V reflection, only what is needed to build pipeline layouts and vertex input state.
+namespace spirv_reflection
+{
+    // Array lengths given by specialization constants take the values specialization_info sets, the
+    // constants' defaults otherwise. Reflect with the info the pipeline is created with.
+    ShaderInterface reflect(const std::string& spirv_path, const VkSpecializationInfo* specialization_info = nullptr);
+
+    // Merges the interfaces of the stages of one program.
+    ShaderInterface reflect_program(const std::vector<std::string>& spirv_path_vec, const VkSpecializationInfo* specialization_info = nullptr);
+};
+
+#endif
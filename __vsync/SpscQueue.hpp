@@ -0,0 +1,69 @@
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+
+#include <array>
+#include <atomic>
+#include <inttypes.h>
+
+// Lock-free single producer / single consumer ring buffer. The blocking push/pop park the
+// calling thread on the index atomics (C++20 atomic wait) instead of spinning.
+template<typename T, uint32_t Capacity>
+struct SpscQueue
+{
+    static_assert((Capacity & (Capacity - 1u)) == 0u, "SpscQueue capacity must be a power of two");
+
+private:
+    std::array<T, Capacity> m_slot_array {};
+    alignas(64) std::atomic<uint32_t> m_head {0u}; // written by the consumer
+    alignas(64) std::atomic<uint32_t> m_tail {0u}; // written by the producer
+
+public:
+    bool try_push(const T& value)
+    {
+        const uint32_t tail = m_tail.load(std::memory_order_relaxed);
+
+        if (tail - m_head.load(std::memory_order_acquire) == Capacity)
+            return false;
+
+        m_slot_array[tail & (Capacity - 1u)] = value;
+        m_tail.store(tail + 1u, std::memory_order_release);
+        m_tail.notify_one();
+        return true;
+    }
+
+    void push(const T& value)
+    {
+        while (!try_push(value))
+        {
+            const uint32_t head = m_head.load(std::memory_order_acquire);
+
+            if (m_tail.load(std::memory_order_relaxed) - head == Capacity)
+                m_head.wait(head, std::memory_order_acquire);
+        }
+    }
+
+    bool try_pop(T& value)
+    {
+        const uint32_t head = m_head.load(std::memory_order_relaxed);
+
+        if (head == m_tail.load(std::memory_order_acquire))
+            return false;
+
+        value = m_slot_array[head & (Capacity - 1u)];
+        m_head.store(head + 1u, std::memory_order_release);
+        m_head.notify_one();
+        return true;
+    }
+
+    T pop()
+    {
+        T value;
+
+        while (!try_pop(value))
+            m_tail.wait(m_head.load(std::memory_order_relaxed), std::memory_order_acquire);
+
+        return value;
+    }
+};
+
+#endif
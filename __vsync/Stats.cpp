@@ -35,11 +35,34 @@ void Stats::pop()
     time_range_vec[idx].second[1] = get_time();
 }
 
+// For ranges measured on another thread (e.g. the present thread).
+void Stats::add(const char* name, uint64_t start_ns, uint64_t end_ns)
+{
+    time_range_vec.push_back({});
+    time_range_vec.back().first = name;
+    time_range_vec.back().second[0] = start_ns;
+    time_range_vec.back().second[1] = end_ns;
+}
+
+// Per frame event counts (e.g. pipelines that finished compiling during the frame).
+void Stats::add_counter(const char* name, uint64_t value)
+{
+    counter_vec.push_back({name, value});
+}
+
+// Pipelines created since the previous frame, with the driver's creation feedback.
+void Stats::add_pipeline_creations(std::vector<vk_core::PipelineCreationFeedback>&& feedback_vec)
+{
+    pipeline_creation_vec.insert(pipeline_creation_vec.end(), std::make_move_iterator(feedback_vec.begin()), std::make_move_iterator(feedback_vec.end()));
+}
+
 void Stats::reset()
 {
     while (!pushed_idx_stack.empty())
         pushed_idx_stack.pop();
     time_range_vec.clear();
+    counter_vec.clear();
+    pipeline_creation_vec.clear();
 }
 
 uint64_t get_calibrated_cpu_gpu_timestamp_delta()
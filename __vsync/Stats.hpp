@@ -9,17 +9,26 @@
 
 #include <vulkan/vulkan.hpp>
 
+#include "vk_core.hpp"
+
 struct Stats 
 {
 private:
     std::stack<int> pushed_idx_stack;
     std::vector<std::pair<std::string, std::array<uint64_t, 2>>> time_range_vec;
+    std::vector<std::pair<std::string, uint64_t>> counter_vec;
+    std::vector<vk_core::PipelineCreationFeedback> pipeline_creation_vec;
 public:
     void push(const char* name);
     void pop();
+    void add(const char* name, uint64_t start_ns, uint64_t end_ns);
+    void add_counter(const char* name, uint64_t value);
+    void add_pipeline_creations(std::vector<vk_core::PipelineCreationFeedback>&& feedback_vec);
     void reset();
 
     const std::vector<std::pair<std::string, std::array<uint64_t, 2>>>& get_cpu_data() { return time_range_vec; } 
+    const std::vector<std::pair<std::string, uint64_t>>& get_counter_data() { return counter_vec; }
+    const std::vector<vk_core::PipelineCreationFeedback>& get_pipeline_creation_data() { return pipeline_creation_vec; }
 };
 
 uint64_t get_calibrated_cpu_gpu_timestamp_delta();
@@ -0,0 +1,80 @@
+#ifndef TRIPLE_BUFFER_HPP
+#define TRIPLE_BUFFER_HPP
+
+#include <array>
+#include <atomic>
+#include <inttypes.h>
+
+// Single producer / single consumer mailbox over three slots. The producer fills get_write_slot() and
+// publishes it, the consumer acquires the published slot. Each side owns one slot and the third one
+// changes hands, so slots (and their allocations) are reused and never copied.
+template<typename T>
+struct TripleBuffer
+{
+private:
+    static constexpr uint32_t slot_idx_mask = 0x3u;
+    static constexpr uint32_t published_bit = 0x4u; // the ready slot has not been acquired yet
+    static constexpr uint32_t closed_bit    = 0x8u;
+
+    std::array<T, 3> m_slot_array {};
+    uint32_t m_write_idx {0u}; // producer only
+    uint32_t m_read_idx {1u};  // consumer only
+    alignas(64) std::atomic<uint32_t> m_ready {2u};
+
+public:
+    T& get_write_slot() { return m_slot_array[m_write_idx]; }
+
+    // Blocks while the previously published slot has not been acquired, so no slot is ever dropped and
+    // the producer runs at most one slot ahead of the one the consumer is working on.
+    void publish()
+    {
+        uint32_t ready = m_ready.load(std::memory_order_acquire);
+
+        while (ready & published_bit)
+        {
+            m_ready.wait(ready, std::memory_order_acquire);
+            ready = m_ready.load(std::memory_order_acquire);
+        }
+
+        m_write_idx = m_ready.exchange(m_write_idx | published_bit | (ready & closed_bit), std::memory_order_acq_rel) & slot_idx_mask;
+        m_ready.notify_one();
+    }
+
+    // Called by the producer, a slot published before closing is still handed out.
+    void close()
+    {
+        m_ready.fetch_or(closed_bit, std::memory_order_release);
+        m_ready.notify_one();
+    }
+
+    // Blocks until a slot is published. Returns nullptr once the buffer is closed and drained.
+    // The slot stays valid until the next acquire.
+    const T* acquire()
+    {
+        uint32_t ready = m_ready.load(std::memory_order_acquire);
+
+        while (true)
+        {
+            if (ready & published_bit)
+            {
+                if (m_ready.compare_exchange_weak(ready, m_read_idx | (ready & closed_bit), std::memory_order_acq_rel, std::memory_order_acquire))
+                    break;
+
+                continue;
+            }
+
+            if (ready & closed_bit)
+                return nullptr;
+
+            m_ready.wait(ready, std::memory_order_acquire);
+            ready = m_ready.load(std::memory_order_acquire);
+        }
+
+        m_read_idx = ready & slot_idx_mask;
+        m_ready.notify_one();
+
+        return &m_slot_array[m_read_idx];
+    }
+};
+
+#endif
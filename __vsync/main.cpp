@@ -17,8 +17,23 @@
 
 #include "vk_core.hpp"
 #include "imgui_wrapper.hpp"
+#include "BindlessTable.hpp"
+#include "DescriptorBuffer.hpp"
+#include "DescriptorUpdateTemplate.hpp"
+#include "ObjectCache.hpp"
 #include "Pipeline.hpp"
+#include "PipelineLayoutCache.hpp"
+#include "PipelineWarmup.hpp"
+#include "ShaderArchive.hpp"
+#include "ShaderModuleCache.hpp"
 #include "FrameResources.hpp"
+#include "PresentThread.hpp"
+#include "RenderPacket.hpp"
+#include "TripleBuffer.hpp"
+
+#ifdef SHADER_HOT_RELOAD
+#include "ShaderHotReload.hpp"
+#endif
 
 #ifdef DEBUG
 #include "Stats.hpp"
@@ -32,7 +47,13 @@ constexpr int32_t window_dim_x = 1200;
 constexpr int32_t window_dim_y = 900;
 constexpr int32_t frame_resouce_count = 3;
 constexpr bool enable_blend = true;
+constexpr bool use_present_thread = true;
 const std::string shader_root_dir = std::string(PROJECT_ROOT_DIR) + "/__vsync/shaders/spirv/";
+const std::string pipeline_cache_path = std::string(PROJECT_ROOT_DIR) + "/build/__vsync/pipeline_cache.bin";
+const std::string pipeline_warmup_path = std::string(PROJECT_ROOT_DIR) + "/build/__vsync/pipeline_warmup.bin";
+#ifdef SHADER_HOT_RELOAD
+const std::string shader_glsl_dir = std::string(PROJECT_ROOT_DIR) + "/__vsync/shaders/glsl/";
+#endif
 
 enum TimePoint : int
 {
@@ -42,18 +63,19 @@ enum TimePoint : int
     MaxEnum
 };
 
-void transition_attachments_to_initial_layout()
+#ifdef DEBUG
+// Stats of a completed frame, sent from the render thread to the main thread which builds the UI.
+struct FrameStatsReport
 {
-    const auto vk_handle_cmd_pool = vk_core::create_command_pool();
-    const auto vk_handle_cmd_buff = vk_core::allocate_command_buffer(vk_handle_cmd_pool, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
-
-    const VkCommandBufferBeginInfo cmd_buff_begin_info {
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-        .pNext = nullptr,
-        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
-        .pInheritanceInfo = nullptr,
-    };
+    int frame_id;
+    std::vector<std::pair<std::string, std::array<uint64_t, 2>>> cpu_data;
+    std::array<uint64_t, 2> gpu_data;
+    std::vector<std::pair<std::string, uint64_t>> counter_data;
+};
+#endif
 
+void transition_attachments_to_initial_layout()
+{
     const VkImageMemoryBarrier transition_to_present_barrier {
         .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
         .pNext = nullptr,
@@ -75,37 +97,62 @@ void transition_attachments_to_initial_layout()
 
     for (auto i = 0; i < swapchain_transition_to_present_barrier_vec.size(); i++)
         swapchain_transition_to_present_barrier_vec[i].image = vk_core::get_swapchain_image(i);
-    
-    const VkSubmitInfo submit_info {
-        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-        .pNext = nullptr,
-        .waitSemaphoreCount = 0u,
-        .pWaitSemaphores = nullptr,
-        .pWaitDstStageMask = 0u,
-        .commandBufferCount = 1u,
-        .pCommandBuffers = &vk_handle_cmd_buff,
-        .signalSemaphoreCount = 0u,
-        .pSignalSemaphores = nullptr,
+
+    // No wait on the returned ticket - the first frame's ALL_COMMANDS barrier orders it after this submission.
+    vk_core::immediate_submit([&swapchain_transition_to_present_barrier_vec](VkCommandBuffer vk_handle_cmd_buff) {
+        vkCmdPipelineBarrier(vk_handle_cmd_buff, 
+            VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+            VK_DEPENDENCY_BY_REGION_BIT,
+            0u, nullptr,
+            0u, nullptr,
+            static_cast<uint32_t>(swapchain_transition_to_present_barrier_vec.size()), swapchain_transition_to_present_barrier_vec.data());
+    });
+}
+
+// Dynamic state of the programs, the blend state only if VK_EXT_extended_dynamic_state3 is enabled. With the
+// blend state dynamic the opaque and blended programs share their fragment output library.
+std::vector<VkDynamicState> get_program_dynamic_states()
+{
+    std::vector<VkDynamicState> dynamic_state_vec = {
+        VK_DYNAMIC_STATE_VIEWPORT_WITH_COUNT,
+        VK_DYNAMIC_STATE_SCISSOR_WITH_COUNT,
+        VK_DYNAMIC_STATE_CULL_MODE,
     };
 
-    vkBeginCommandBuffer(vk_handle_cmd_buff, &cmd_buff_begin_info);
+    if (vk_core::is_device_extension_enabled(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME))
+    {
+        dynamic_state_vec.push_back(VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT);
+        dynamic_state_vec.push_back(VK_DYNAMIC_STATE_COLOR_BLEND_EQUATION_EXT);
+    }
 
-    vkCmdPipelineBarrier(vk_handle_cmd_buff, 
-        VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-        VK_DEPENDENCY_BY_REGION_BIT,
-        0u, nullptr,
-        0u, nullptr,
-        static_cast<uint32_t>(swapchain_transition_to_present_barrier_vec.size()), swapchain_transition_to_present_barrier_vec.data());
+    return dynamic_state_vec;
+}
 
-    vkEndCommandBuffer(vk_handle_cmd_buff);
+void set_dynamic_state(VkCommandBuffer vk_handle_cmd_buff, const Camera& camera, const DynamicGraphicsState& dynamic_state)
+{
+    const VkViewport viewport {
+        .x = 0.0f,
+        .y = 0.0f,
+        .width = static_cast<float>(camera.extent.width),
+        .height = static_cast<float>(camera.extent.height),
+        .minDepth = 0.0f,
+        .maxDepth = 1.0f,
+    };
 
-    vk_core::queue_submit(submit_info, VK_NULL_HANDLE);
-    vk_core::queue_wait_idle();
+    const VkRect2D scissor {
+        .offset = {0, 0},
+        .extent = camera.extent,
+    };
+
+    vk_core::cmd_set_viewport_with_count(vk_handle_cmd_buff, {viewport});
+    vk_core::cmd_set_scissor_with_count(vk_handle_cmd_buff, {scissor});
+    vk_core::cmd_set_cull_mode(vk_handle_cmd_buff, dynamic_state.cull_mode);
 
-    vk_core::destroy_command_pool(vk_handle_cmd_pool);
+    vk_core::cmd_set_color_blend_enable_EXT(vk_handle_cmd_buff, 0u, {dynamic_state.blend_enable});
+    vk_core::cmd_set_color_blend_equation_EXT(vk_handle_cmd_buff, 0u, {dynamic_state.blend_equation});
 }
 
-std::pair<VkPipeline, VkPipelineLayout> compile_program(VkFormat color_format)
+Compiler_GraphicsProgram configure_program(VkFormat color_format, bool blend)
 {
     const VkViewport viewport {
         .x = 0.0f,
@@ -123,7 +170,7 @@ std::pair<VkPipeline, VkPipelineLayout> compile_program(VkFormat color_format)
 
     std::vector<VkPipelineColorBlendAttachmentState> color_attachment_blend_state_vec;
 
-    if (enable_blend)
+    if (blend)
     {
         const VkPipelineColorBlendAttachmentState blend_state {
             .blendEnable = VK_TRUE,
@@ -157,8 +204,6 @@ std::pair<VkPipeline, VkPipelineLayout> compile_program(VkFormat color_format)
     // TODO  - have compiler check for completeness before compile call
     Compiler_GraphicsProgram compiler;
     compiler.set_shaders({shader_root_dir + "default.vert", shader_root_dir + "default.frag"});
-    compiler.set_vertex_input_bindings({});
-    compiler.set_vertex_input_attributes({});
     compiler.set_topology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
     compiler.set_viewport({viewport});
     compiler.set_scissor({scissor});
@@ -167,8 +212,15 @@ std::pair<VkPipeline, VkPipelineLayout> compile_program(VkFormat color_format)
     compiler.set_depth_state(VK_FALSE, VK_FALSE, VK_COMPARE_OP_NEVER, {0.0f, 1.0f});
     compiler.set_color_attachment_blend_state(color_attachment_blend_state_vec);
     compiler.set_color_attachment_format({color_format});
+    compiler.set_dynamic_state(get_program_dynamic_states());
 
-    return compiler.compile();
+    // The fragment shader's alpha is compiled in, blending is pointless without it.
+    compiler.set_specialization_constants({
+        {.name = "translucent", .constant_id = 0u, .value_domain = {VK_FALSE, VK_TRUE}},
+    });
+    compiler.set_variant(compiler.make_variant_key({{"translucent", blend ? VK_TRUE : VK_FALSE}}));
+
+    return compiler;
 }
 
 void print_stats(const char* name, uint64_t start_tick, uint64_t end_tick, uint64_t zero_tick, float gpu_timestamp_period)
@@ -200,7 +252,6 @@ void test_gui(
     const std::vector<std::vector<std::pair<std::string, std::array<uint64_t, 2>>>>& cpu_data_vec,
     const std::vector<std::vector<std::pair<std::string, std::array<uint64_t, 2>>>>& gpu_data_vec)
 {
-    assert(frame_id_vec.size() > 0);
     assert(frame_id_vec.size() == cpu_data_vec.size());
     assert(frame_id_vec.size() == gpu_data_vec.size());
 
@@ -377,7 +428,7 @@ void test_gui(
             int j = 0;
             for (auto& stat : local_cpu_data_vec[i])
             {
-                ImPlot::SetNextLineStyle(cpu_stat_colors[j], 5);
+                ImPlot::SetNextLineStyle(cpu_stat_colors[j % cpu_stat_colors.size()], 5);
                 ImPlot::PlotLine(stat.first.c_str(), stat.second.data(), y_data, 2);
                 j++;
             }
@@ -427,9 +478,28 @@ int main()
         .presentId = VK_TRUE,
     };
 
+    const VkPhysicalDeviceVulkan12Features features_12 {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+        .pNext = nullptr, // (void*)(&present_id_feature),
+        // bindless_table
+        .descriptorIndexing = VK_TRUE,
+        .shaderSampledImageArrayNonUniformIndexing = VK_TRUE,
+        .shaderStorageBufferArrayNonUniformIndexing = VK_TRUE,
+        .descriptorBindingSampledImageUpdateAfterBind = VK_TRUE,
+        .descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE,
+        .descriptorBindingUpdateUnusedWhilePending = VK_TRUE,
+        .descriptorBindingPartiallyBound = VK_TRUE,
+        .runtimeDescriptorArray = VK_TRUE,
+        .timelineSemaphore = VK_TRUE,
+        .bufferDeviceAddress = VK_TRUE, // DeviceAddressBuffer
+    };
+
     const VkPhysicalDeviceVulkan13Features features_13 {
         .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
-        .pNext = nullptr, // (void*)(&present_id_feature),
+        .pNext = (void*)(&features_12),
+        .subgroupSizeControl = VK_TRUE,   // Compiler_ComputeProgram::set_required_subgroup_size
+        .computeFullSubgroups = VK_TRUE,
+        .synchronization2 = VK_TRUE,
         .dynamicRendering = VK_TRUE,
     };
 
@@ -456,6 +526,17 @@ int main()
             VK_NV_LOW_LATENCY_2_EXTENSION_NAME,
             VK_KHR_CALIBRATED_TIMESTAMPS_EXTENSION_NAME,
         },
+        .optional_device_extensions = {
+            // Compiler_GraphicsProgram falls back to monolithic pipelines without these.
+            VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME,
+            VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME,
+            // Blend state is baked into the programs without it.
+            VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME,
+            // Descriptors are bound as sets from pools without it (descriptor_backend).
+            VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME,
+            // Compiler_GraphicsProgram::set_push_descriptor_set
+            VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME,
+        },
         .swapchain_image_format = VK_FORMAT_B8G8R8A8_SRGB,
         .swapchain_min_image_count = 2u,
         .swapchain_image_extent = {window_dim_x , window_dim_y},
@@ -463,18 +544,59 @@ int main()
         // .swapchain_present_mode = VK_PRESENT_MODE_FIFO_RELAXED_KHR,
         // .swapchain_present_mode = VK_PRESENT_MODE_IMMEDIATE_KHR,
         // .swapchain_present_mode = VK_PRESENT_MODE_MAILBOX_KHR,
+        .pipeline_cache_path = pipeline_cache_path.c_str(),
     };
 
     vk_core::init(init_info);
 
+#ifdef DEBUG
+    vk_core::set_pipeline_creation_feedback_recording(true);
+#endif
+
     imgui_wrapper::init(glfw_window, init_info.swapchain_image_format);
+    bindless_table::init();
 
     auto frame_resource_vec = std::vector<FrameResources>(frame_resouce_count);
 
     std::vector<Stats> frame_stats_vec(frame_resouce_count);
     std::vector<std::array<uint64_t, 2>> frame_gpu_query_data_vec(frame_resouce_count);
 
-    const auto [vk_handle_pipeline, vk_handle_pipeline_layout] = compile_program(init_info.swapchain_image_format);
+#ifdef SHADER_ARCHIVE_PATH
+    // Built by the vsync_shaders target, replaces the SPIR-V files under shader_root_dir.
+    shader_archive::open(SHADER_ARCHIVE_PATH, shader_root_dir);
+#endif
+
+    pipeline_compile_workers::start(1u);
+    pipeline_warmup::load(pipeline_warmup_path);
+
+    // The opaque variant is compiled up front so there is something to draw with while the blended one compiles.
+    const std::shared_ptr<AsyncGraphicsProgram> fallback_program = configure_program(init_info.swapchain_image_format, false).compile();
+    const VkPipeline vk_handle_fallback_pipeline = fallback_program->wait().first;
+    const Compiler_GraphicsProgram program_compiler = configure_program(init_info.swapchain_image_format, enable_blend);
+    auto program = program_compiler.compile_async();
+
+    // Every variant the program may be drawn with, the ones earlier sessions used are precompiled.
+    std::vector<Compiler_GraphicsProgram> warmup_candidate_vec;
+
+    for (const VariantKey& variant_key : program_compiler.get_all_variant_keys())
+    {
+        warmup_candidate_vec.push_back(program_compiler);
+        warmup_candidate_vec.back().set_variant(variant_key);
+    }
+
+    const std::vector<std::shared_ptr<AsyncGraphicsProgram>> warmup_program_vec = pipeline_warmup::precompile(warmup_candidate_vec);
+
+    // Startup content is loaded, samplers and layouts it released are not needed anymore.
+    object_cache::trim();
+
+#ifdef SHADER_HOT_RELOAD
+    // Programs using a reloaded shader are recompiled in the background and swapped in once ready.
+    ShaderHotReload shader_hot_reload;
+    shader_hot_reload.start(shader_glsl_dir, shader_root_dir);
+
+    std::shared_ptr<AsyncGraphicsProgram> reloading_program;
+    bool program_reload_requested = false;
+#endif
 
     const auto vk_handle_swapchain_image_acquire_fence = vk_core::create_fence();
 
@@ -486,355 +608,564 @@ int main()
 
     transition_attachments_to_initial_layout();
 
-    uint64_t frame_counter = 0lu;
-    int32_t active_frame_res_idx = -1;
-    uint64_t cpu_gpu_delta = 0lu;
+    PresentThread present_thread;
 
-    while (!glfwWindowShouldClose(glfw_window))
-    {
-        const int32_t prev_frame_res_idx = active_frame_res_idx;
-        active_frame_res_idx = (active_frame_res_idx + 1) % frame_resouce_count;
-        const auto& frame_resource = frame_resource_vec[active_frame_res_idx];
+    if (use_present_thread)
+        present_thread.start(frame_resouce_count);
+
+    // The main thread polls input, simulates and builds the UI into a render packet. The render thread
+    // records, submits and hands the frame to the present thread. Frame N+1 is built while frame N is recorded.
+    TripleBuffer<RenderPacket> render_packet_buffer;
 
 #ifdef DEBUG
-        const auto cpu_gpu_timestamp_delta = get_calibrated_cpu_gpu_timestamp_delta();
+    SpscQueue<FrameStatsReport, 8> frame_stats_report_queue;
+#endif
 
-        Stats frame_stats;
-        frame_stats.push("CPU - Frame");
+    std::thread render_thread([&]() {
+        int32_t active_frame_res_idx = -1;
+        uint64_t cpu_gpu_delta = 0lu;
 
-        const auto debug_frame_name = "Frame[" + std::to_string(frame_counter) + "][" + std::to_string(active_frame_res_idx) + "]";
-        const auto debug_cmd_buff_name = "Frame[" + std::to_string(active_frame_res_idx) + "] - CommandBuffer";
+        while (const RenderPacket* const render_packet = render_packet_buffer.acquire())
+        {
+            const uint64_t frame_counter = render_packet->frame_id;
 
-        vk_core::set_latency_marker_NV(frame_counter, VK_LATENCY_MARKER_INPUT_SAMPLE_NV);
-        vk_core::set_latency_marker_NV(frame_counter, VK_LATENCY_MARKER_SIMULATION_START_NV); 
-        vk_core::set_latency_marker_NV(frame_counter, VK_LATENCY_MARKER_SIMULATION_END_NV);
+            const int32_t prev_frame_res_idx = active_frame_res_idx;
+            active_frame_res_idx = (active_frame_res_idx + 1) % frame_resouce_count;
+            auto& frame_resource = frame_resource_vec[active_frame_res_idx];
+
+#ifdef DEBUG
+            const auto cpu_gpu_timestamp_delta = get_calibrated_cpu_gpu_timestamp_delta();
+
+            Stats frame_stats;
+            frame_stats.push("CPU - Frame");
+
+            for (const auto& [name, time_range] : render_packet->main_thread_cpu_data)
+                frame_stats.add(name.c_str(), time_range[0], time_range[1]);
+
+            const auto debug_frame_name = "Frame[" + std::to_string(frame_counter) + "][" + std::to_string(active_frame_res_idx) + "]";
+            const auto debug_cmd_buff_name = "Frame[" + std::to_string(active_frame_res_idx) + "] - CommandBuffer";
 #endif
-        glfwPollEvents();
 
-        // We must wait for the commad buffers to not be in use.
+            // We must wait for the commad buffers to not be in use.
 #ifdef DEBUG
-        frame_stats.push("CPU - Fence - Frame Resource");
+            frame_stats.push("CPU - Fence - Frame Resource");
 #endif
 
-        vk_core::wait_for_fence(frame_resource.vk_handle_fence, UINT64_MAX);
-        vk_core::reset_fence(frame_resource.vk_handle_fence);
+            vk_core::wait_for_fence(frame_resource.vk_handle_fence, UINT64_MAX);
+            vk_core::reset_fence(frame_resource.vk_handle_fence);
+
+            vk_core::run_deferred_destructions();
 
 #ifdef DEBUG
-        frame_stats.pop();
+            frame_stats.pop();
 
-        std::array<uint64_t, 2> frame_gpu_query_data;
+            std::array<uint64_t, 2> frame_gpu_query_data;
 
-        frame_stats.push("CPU - Query Pool Results Call");
-        if (frame_counter > frame_resouce_count)
-            vk_core::get_query_pool_results(frame_resource.vk_handle_query_pool, 0, 2, sizeof(uint64_t) * 2, frame_gpu_query_data.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
-        frame_stats.pop();
+            frame_stats.push("CPU - Query Pool Results Call");
+            if (frame_counter > frame_resouce_count)
+            {
+                vk_core::get_query_pool_results(frame_resource.vk_handle_query_pool, 0, 2, sizeof(uint64_t) * 2, frame_gpu_query_data.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+
+                // This frame resource's previous run is complete, hand its stats to the main thread for the UI.
+                // Dropped if the main thread falls behind, the UI only needs the most recent frames.
+                frame_stats_report_queue.try_push({
+                    .frame_id = static_cast<int>(frame_counter - frame_resouce_count),
+                    .cpu_data = frame_stats_vec[active_frame_res_idx].get_cpu_data(),
+                    .gpu_data = {
+                        frame_gpu_query_data[0] - cpu_gpu_timestamp_delta,
+                        frame_gpu_query_data[1] - cpu_gpu_timestamp_delta,
+                    },
+                    .counter_data = frame_stats_vec[active_frame_res_idx].get_counter_data(),
+                });
+            }
+            frame_stats.pop();
 
-        frame_stats.push("CPU - Image Acquire Call");
+            frame_stats.add_counter("Pipelines Compiled", pipeline_compile_workers::take_completed_count());
+            if (descriptor_backend::uses_descriptor_buffers())
+                frame_stats.add_counter("Descriptor Buffer Size", frame_resource.desc_buffer_allocator.get_size());
+            else
+                frame_stats.add_counter("Descriptor Pools", frame_resource.desc_allocator.get_pool_count());
+
+            frame_stats.push("CPU - Image Acquire Call");
 #endif
 
-        // Acquire index of next presentable image in the swapchain. This function blocks until an image can be acquired.
-        // The presentation engine may not be done using the image on return.
-        const auto next_avail_swapchain_image_idx = vk_core::acquire_next_swapchain_image(VK_NULL_HANDLE, vk_handle_swapchain_image_acquire_fence);
+            // Acquire index of next presentable image in the swapchain. This function blocks until an image can be acquired.
+            // The presentation engine may not be done using the image on return (unless it comes from the present thread,
+            // which already waited on the acquire fence).
+            const auto next_avail_swapchain_image_idx = use_present_thread
+                ? present_thread.pop_acquired_image()
+                : vk_core::acquire_next_swapchain_image(VK_NULL_HANDLE, vk_handle_swapchain_image_acquire_fence);
+
+            vk_core::reset_command_pool(frame_resource.vk_handle_cmd_pool);
+            if (descriptor_backend::uses_descriptor_buffers())
+                frame_resource.desc_buffer_allocator.reset();
+            else
+                frame_resource.desc_allocator.reset();
+
+            vk_core::begin_command_buffer(frame_resource.vk_handle_cmd_buff, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+            if (descriptor_backend::uses_descriptor_buffers())
+                frame_resource.desc_buffer_allocator.bind(frame_resource.vk_handle_cmd_buff);
 
-        vk_core::reset_command_pool(frame_resource.vk_handle_cmd_pool);
-        vk_core::begin_command_buffer(frame_resource.vk_handle_cmd_buff, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
-    
 #ifdef DEBUG
-        frame_stats.pop();
-        vk_core::debug_utils_begin_label(frame_resource.vk_handle_cmd_buff, debug_cmd_buff_name.c_str());
-        frame_stats.push("CPU - Record");
+            frame_stats.pop();
+            vk_core::debug_utils_begin_label(frame_resource.vk_handle_cmd_buff, debug_cmd_buff_name.c_str());
+            frame_stats.push("CPU - Record");
 #endif
 
-        // Command Buffer Record
-        {
-            const VkImageMemoryBarrier transition_to_render_image_barrier {
-                .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                .pNext = nullptr,
-                .oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-                .newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                .srcQueueFamilyIndex = vk_core::get_queue_family_idx(),
-                .dstQueueFamilyIndex = vk_core::get_queue_family_idx(),
-                .image = vk_core::get_swapchain_image(next_avail_swapchain_image_idx),
-                .subresourceRange = {
-                    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-                    .baseMipLevel = 0u,
-                    .levelCount = 1u,
-                    .baseArrayLayer = 0u,
-                    .layerCount = 1u,
-                },
-            }; 
-
-            const VkImageMemoryBarrier transition_to_present_image_barrier {
-                .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                .pNext = nullptr,
-                .oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                .newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-                .srcQueueFamilyIndex = vk_core::get_queue_family_idx(),
-                .dstQueueFamilyIndex = vk_core::get_queue_family_idx(),
-                .image = vk_core::get_swapchain_image(next_avail_swapchain_image_idx),
-                .subresourceRange = {
-                    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-                    .baseMipLevel = 0u,
-                    .levelCount = 1u,
-                    .baseArrayLayer = 0u,
+            // Command Buffer Record
+            {
+                const VkImageMemoryBarrier transition_to_render_image_barrier {
+                    .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                    .pNext = nullptr,
+                    .oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+                    .newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                    .srcQueueFamilyIndex = vk_core::get_queue_family_idx(),
+                    .dstQueueFamilyIndex = vk_core::get_queue_family_idx(),
+                    .image = vk_core::get_swapchain_image(next_avail_swapchain_image_idx),
+                    .subresourceRange = {
+                        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                        .baseMipLevel = 0u,
+                        .levelCount = 1u,
+                        .baseArrayLayer = 0u,
+                        .layerCount = 1u,
+                    },
+                };
+
+                const VkImageMemoryBarrier transition_to_present_image_barrier {
+                    .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                    .pNext = nullptr,
+                    .oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                    .newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+                    .srcQueueFamilyIndex = vk_core::get_queue_family_idx(),
+                    .dstQueueFamilyIndex = vk_core::get_queue_family_idx(),
+                    .image = vk_core::get_swapchain_image(next_avail_swapchain_image_idx),
+                    .subresourceRange = {
+                        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                        .baseMipLevel = 0u,
+                        .levelCount = 1u,
+                        .baseArrayLayer = 0u,
+                        .layerCount = 1u,
+                    },
+                };
+
+                const VkClearValue clear_value {
+                    .color = render_packet->camera.clear_color
+                };
+
+                const VkRenderingAttachmentInfo color_attachment_info {
+                    .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+                    .pNext = nullptr,
+                    .imageView = vk_core::get_swapchain_image_view(next_avail_swapchain_image_idx),
+                    .imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                    .resolveMode = VK_RESOLVE_MODE_NONE,
+                    .resolveImageView = VK_NULL_HANDLE,
+                    .resolveImageLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+                    .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+                    .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+                    .clearValue = clear_value
+                };
+
+                const VkRenderingInfo rendering_info {
+                    .sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+                    .pNext = nullptr,
+                    .flags = 0x0,
+                    .renderArea = {.offset={}, .extent=render_packet->camera.extent},
                     .layerCount = 1u,
-                },
-            }; 
-
-            const VkClearValue clear_value {
-                .color = {0.1f, 0.1f, 0.1f, 0.0f}
-            };
-
-            const VkRenderingAttachmentInfo color_attachment_info {
-                .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
-                .pNext = nullptr,
-                .imageView = vk_core::get_swapchain_image_view(next_avail_swapchain_image_idx),
-                .imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                .resolveMode = VK_RESOLVE_MODE_NONE,
-                .resolveImageView = VK_NULL_HANDLE,
-                .resolveImageLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-                .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
-                .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
-                .clearValue = clear_value
-            };
-
-            const VkRenderingInfo rendering_info {
-                .sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
-                .pNext = nullptr,
-                .flags = 0x0,
-                .renderArea = {.offset={}, .extent={window_dim_x, window_dim_y}},
-                .layerCount = 1u,
-                .viewMask = 0x0,
-                .colorAttachmentCount = 1u,
-                .pColorAttachments = &color_attachment_info,
-                .pDepthAttachment = nullptr,
-                .pStencilAttachment = nullptr,
-            };
-
-#ifdef DEBUG 
-            vkCmdResetQueryPool(frame_resource.vk_handle_cmd_buff, frame_resource.vk_handle_query_pool, 0, 2);
-            vkCmdWriteTimestamp(frame_resource.vk_handle_cmd_buff, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame_resource.vk_handle_query_pool, 0);
-#endif
-
-            vkCmdPipelineBarrier(frame_resource.vk_handle_cmd_buff,
-                VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-                VK_DEPENDENCY_BY_REGION_BIT,
-                0u, nullptr,
-                0u, nullptr,
-                1u, &transition_to_render_image_barrier);
-
-            vkCmdBeginRendering(frame_resource.vk_handle_cmd_buff, &rendering_info);
+                    .viewMask = 0x0,
+                    .colorAttachmentCount = 1u,
+                    .pColorAttachments = &color_attachment_info,
+                    .pDepthAttachment = nullptr,
+                    .pStencilAttachment = nullptr,
+                };
 
 #ifdef DEBUG
-            vk_core::debug_utils_begin_label(frame_resource.vk_handle_cmd_buff, "render");
+                vkCmdResetQueryPool(frame_resource.vk_handle_cmd_buff, frame_resource.vk_handle_query_pool, 0, 2);
+                vkCmdWriteTimestamp(frame_resource.vk_handle_cmd_buff, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame_resource.vk_handle_query_pool, 0);
 #endif
 
-            {
-                vkCmdBindPipeline(frame_resource.vk_handle_cmd_buff, VK_PIPELINE_BIND_POINT_GRAPHICS, vk_handle_pipeline);
-                vkCmdDraw(frame_resource.vk_handle_cmd_buff, 3, 10000, 0, 0);
-                std::this_thread::sleep_for(std::chrono::milliseconds(18));
+                vkCmdPipelineBarrier(frame_resource.vk_handle_cmd_buff,
+                    VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                    VK_DEPENDENCY_BY_REGION_BIT,
+                    0u, nullptr,
+                    0u, nullptr,
+                    1u, &transition_to_render_image_barrier);
+
+                vkCmdBeginRendering(frame_resource.vk_handle_cmd_buff, &rendering_info);
+
+#ifdef DEBUG
+                vk_core::debug_utils_begin_label(frame_resource.vk_handle_cmd_buff, "render");
+#endif
+
+                {
+                    for (const auto& draw_cmd : render_packet->draw_cmd_vec)
+                    {
+                        vkCmdBindPipeline(frame_resource.vk_handle_cmd_buff, VK_PIPELINE_BIND_POINT_GRAPHICS, draw_cmd.vk_handle_pipeline);
+                        set_dynamic_state(frame_resource.vk_handle_cmd_buff, render_packet->camera, draw_cmd.dynamic_state);
+                        vkCmdDraw(frame_resource.vk_handle_cmd_buff, draw_cmd.vertex_count, draw_cmd.instance_count, 0, 0);
+                    }
+
+                    std::this_thread::sleep_for(std::chrono::milliseconds(18));
+                }
+
+#ifdef DEBUG
+                if (render_packet->ui_draw_data.draw_data.Valid)
+                {
+                    // The backend only reads the draw data, it just is not const correct.
+                    ImGui_ImplVulkan_RenderDrawData(const_cast<ImDrawData*>(&render_packet->ui_draw_data.draw_data), frame_resource.vk_handle_cmd_buff);
+                }
+
+                vk_core::debug_utils_end_label(frame_resource.vk_handle_cmd_buff);
+#endif
+
+                vkCmdEndRendering(frame_resource.vk_handle_cmd_buff);
+
+                vkCmdPipelineBarrier(frame_resource.vk_handle_cmd_buff,
+                    VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                    VK_DEPENDENCY_BY_REGION_BIT,
+                    0u, nullptr,
+                    0u, nullptr,
+                    1u, &transition_to_present_image_barrier);
+
+#ifdef DEBUG
+                vkCmdWriteTimestamp(frame_resource.vk_handle_cmd_buff, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame_resource.vk_handle_query_pool, 1);
+#endif
             }
 
 #ifdef DEBUG
-            if (frame_counter > (frame_resouce_count * 2))
-            {
-                ImGui_ImplVulkan_NewFrame();
-                ImGui_ImplGlfw_NewFrame();
-                ImGui::NewFrame();
+            frame_stats.pop();
+            vk_core::debug_utils_end_label(frame_resource.vk_handle_cmd_buff);
+#endif
 
-                static int max_size = 1;
+            vk_core::end_command_buffer(frame_resource.vk_handle_cmd_buff);
 
-                static std::vector<int> frame_id_vec;
-                static std::vector<std::vector<std::pair<std::string, std::array<uint64_t, 2>>>> cpu_data_vec;
-                static std::vector<std::vector<std::pair<std::string, std::array<uint64_t, 2>>>> gpu_data_vec;
+            // Wait for the prpesentation engine to be finished with the image.
+#ifdef DEBUG
+            frame_stats.push("CPU - Fence - Image Acquire");
+#endif
 
-                frame_id_vec.push_back(frame_counter - 1);
-                cpu_data_vec.push_back(frame_stats_vec[active_frame_res_idx].get_cpu_data()); // 2 frames ago
-                gpu_data_vec.push_back({});
-                gpu_data_vec.back().push_back({});
-                gpu_data_vec.back().front().first = "GPU";
-                gpu_data_vec.back().front().second = {
-                    frame_gpu_query_data[0] - cpu_gpu_timestamp_delta,
-                    frame_gpu_query_data[1] - cpu_gpu_timestamp_delta,
+            if (!use_present_thread)
+            {
+                vk_core::wait_for_fence(vk_handle_swapchain_image_acquire_fence, UINT64_MAX);
+                vk_core::reset_fence(vk_handle_swapchain_image_acquire_fence);
+            }
+
+#ifdef DEBUG
+            frame_stats.pop();
+            frame_stats.push("CPU - Submit");
+            vk_core::set_latency_marker_NV(frame_counter, VK_LATENCY_MARKER_RENDERSUBMIT_START_NV);
+#endif
+
+            // Submit
+            {
+                const VkLatencySubmissionPresentIdNV latency_submission_present {
+                    .sType = VK_STRUCTURE_TYPE_LATENCY_SUBMISSION_PRESENT_ID_NV,
+                    .pNext = nullptr,
+                    .presentID = frame_counter,
                 };
 
-                if (frame_id_vec.size() > max_size)
-                {
-                    frame_id_vec.erase(frame_id_vec.begin());
-                    cpu_data_vec.erase(cpu_data_vec.begin());
-                    gpu_data_vec.erase(gpu_data_vec.begin());
-                }
+                vk_core::enqueue_submit(
+                    {frame_resource.vk_handle_cmd_buff},
+                    {},
+                    {vk_core::semaphore_submit_info(frame_resource.vk_handle_render_complete_sem4, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT)},
+                    &latency_submission_present);
 
-                // I do not have my previous frame's GPU queries at this point. The GPU work for the previous frame
-                // could still be executing.
-                // I do have GPU work for (frame_counter-1) (this frame resources' previous run).
+                // All work for the frame goes to the driver in one vkQueueSubmit2 call.
+                const uint64_t submit_timeline_value = vk_core::flush_submit_batch(frame_resource.vk_handle_fence);
 
-                std::cout << "\n0 - Prev Frame Start      : " << cpu_data_vec.front().front().second[0] << '\n';
-                std::cout <<   "0 - Prev Frame Query Start: " << frame_gpu_query_data[0] - cpu_gpu_timestamp_delta << '\n';
-                std::cout <<   "0 - Prev Frame Query End  : " << frame_gpu_query_data[1] - cpu_gpu_timestamp_delta << '\n';
-                std::cout <<   "0 - Prev Frame End        : " << cpu_data_vec.front().front().second[1] << '\n';
+                for (const auto& destroy_func : render_packet->deferred_destroy_vec)
+                    vk_core::defer_destruction(submit_timeline_value, std::function<void()>(destroy_func));
+                // vk_core::device_wait_idle();
+            }
 
-                const uint64_t divider = 1000;
-                const uint64_t zero_tick = cpu_data_vec.front().front().second[0];
+#ifdef DEBUG
+            frame_stats.pop();
+            frame_stats.push("CPU - Present Call");
+            vk_core::set_latency_marker_NV(frame_counter, VK_LATENCY_MARKER_RENDERSUBMIT_END_NV);
+#endif
 
-                std::cout << "1 - Prev Frame Start      : " << ((cpu_data_vec.front().front().second[0]) - zero_tick)  / divider << '\n';
-                std::cout << "1 - Prev Frame Query Start: " << (((gpu_data_vec.back().front().second[0])     ) - zero_tick)  / divider << '\n';
-                std::cout << "1 - Prev Frame Query End  : " << (((gpu_data_vec.back().front().second[1])     ) - zero_tick)  / divider << '\n';
-                std::cout << "1 - Prev Frame End        : " << ((cpu_data_vec.front().front().second[1]) - zero_tick)  / divider << '\n';
+            // Present
+            if (use_present_thread)
+            {
+                // The present thread sets the PRESENT_START/END latency markers around its vkQueuePresentKHR.
+                present_thread.push_present({
+                    .swapchain_image_idx = next_avail_swapchain_image_idx,
+                    .vk_handle_wait_sem4 = frame_resource.vk_handle_render_complete_sem4,
+                    .present_id = frame_counter,
+                });
+            }
+            else
+            {
+                vk_core::set_latency_marker_NV(frame_counter, VK_LATENCY_MARKER_PRESENT_START_NV);
 
-                test_gui(frame_id_vec, cpu_data_vec, gpu_data_vec);
+                const VkPresentIdKHR present_id_obj {
+                    .sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR,
+                    .pNext = nullptr,
+                    .swapchainCount = 1u,
+                    .pPresentIds = &frame_counter
+                };
 
-                // ImPlot::ShowDemoWindow();
+                vk_core::present(next_avail_swapchain_image_idx, {frame_resource.vk_handle_render_complete_sem4}, (void*)(&present_id_obj));
 
-                ImGui::Render();
-                ImDrawData* draw_data = ImGui::GetDrawData();
-                ImGui_ImplVulkan_RenderDrawData(draw_data, frame_resource.vk_handle_cmd_buff);
+                vk_core::set_latency_marker_NV(frame_counter, VK_LATENCY_MARKER_PRESENT_END_NV);
             }
 
-            vk_core::debug_utils_end_label(frame_resource.vk_handle_cmd_buff);
+#ifdef DEBUG
+            frame_stats.pop();
+
+            present_thread.drain_blocking_times([&frame_stats](const PresentThread::BlockingTime& blocking_time) {
+                frame_stats.add(blocking_time.name, blocking_time.start_ns, blocking_time.end_ns);
+            });
 #endif
 
-            vkCmdEndRendering(frame_resource.vk_handle_cmd_buff);
+#if 0
+            {
+                for (uint32_t i = 0; i < frame_latency_timing_array.size(); i++)
+                {
+                    frame_latency_timing_array[i].sType = VK_STRUCTURE_TYPE_LATENCY_TIMINGS_FRAME_REPORT_NV;
+                    frame_latency_timing_array[i].pNext = nullptr;
+                    frame_latency_timing_array[i].presentID = 0u;
+                }
+
+                VkGetLatencyMarkerInfoNV latency_marker_info {
+                    .sType = VK_STRUCTURE_TYPE_GET_LATENCY_MARKER_INFO_NV,
+                    .pNext = nullptr,
+                    .timingCount = static_cast<uint32_t>(frame_latency_timing_array.size()),
+                    .pTimings = frame_latency_timing_array.data(),
+                };
+
+                vk_core::get_latency_timings_NV(&latency_marker_info);
+
+                const uint64_t zero_tick = frame_latency_timing_array.front().inputSampleTimeUs;
 
-            vkCmdPipelineBarrier(frame_resource.vk_handle_cmd_buff, 
-                VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-                VK_DEPENDENCY_BY_REGION_BIT,
-                0u, nullptr,
-                0u, nullptr,
-                1u, &transition_to_present_image_barrier);
+                for (const auto& frame_latency_timings : frame_latency_timing_array)
+                {
+                    std::cout << frame_counter << " " << frame_latency_timings.presentID << '\n';
+                    print_stats("\tSimTime     ", frame_latency_timings.simStartTimeUs, frame_latency_timings.simEndTimeUs, zero_tick, gpu_timestamp_period);
+                    print_stats("\tRenderSubmit", frame_latency_timings.renderSubmitStartTimeUs, frame_latency_timings.renderSubmitEndTimeUs, zero_tick, gpu_timestamp_period);
+                    print_stats("\tGPURender   ", frame_latency_timings.gpuRenderStartTimeUs, frame_latency_timings.gpuRenderEndTimeUs, zero_tick, gpu_timestamp_period);
+                    print_stats("\tPresent     ", frame_latency_timings.presentStartTimeUs, frame_latency_timings.presentEndTimeUs, zero_tick, gpu_timestamp_period);
+                    // print_stats("Driver      ", frame_latency_timings.driverStartTimeUs, frame_latency_timings.driverEndTimeUs, zero_tick, gpu_timestamp_period);
+                    print_stats("\tOsRenderQ   ", frame_latency_timings.osRenderQueueStartTimeUs, frame_latency_timings.osRenderQueueEndTimeUs, zero_tick, gpu_timestamp_period);
+                    std::cout << '\n';
+                }
+            }
+#endif
 
 #ifdef DEBUG
-            vkCmdWriteTimestamp(frame_resource.vk_handle_cmd_buff, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame_resource.vk_handle_query_pool, 1);
+            frame_stats.pop();
+            frame_stats_vec[active_frame_res_idx] = frame_stats;
+            frame_gpu_query_data_vec[active_frame_res_idx] = frame_gpu_query_data;
 #endif
         }
+    });
+
+    uint64_t frame_counter = 0lu;
 
 #ifdef DEBUG
-        frame_stats.pop();
-        vk_core::debug_utils_end_label(frame_resource.vk_handle_cmd_buff);
+    std::vector<int> frame_id_vec;
+    std::vector<std::vector<std::pair<std::string, std::array<uint64_t, 2>>>> cpu_data_vec;
+    std::vector<std::vector<std::pair<std::string, std::array<uint64_t, 2>>>> gpu_data_vec;
+    std::unordered_map<std::string, uint64_t> counter_total_map;
+    std::vector<vk_core::PipelineCreationFeedback> pipeline_creation_vec;
 #endif
 
-        vk_core::end_command_buffer(frame_resource.vk_handle_cmd_buff);
+    while (!glfwWindowShouldClose(glfw_window))
+    {
+        RenderPacket& render_packet = render_packet_buffer.get_write_slot();
 
-        // Wait for the prpesentation engine to be finished with the image.
 #ifdef DEBUG
-        frame_stats.push("CPU - Fence - Image Acquire");
-#endif
+        Stats main_thread_stats;
+        main_thread_stats.push("CPU - Main Thread - Simulation");
 
-        vk_core::wait_for_fence(vk_handle_swapchain_image_acquire_fence, UINT64_MAX);
-        vk_core::reset_fence(vk_handle_swapchain_image_acquire_fence);
+        vk_core::set_latency_marker_NV(frame_counter, VK_LATENCY_MARKER_INPUT_SAMPLE_NV);
+#endif
+        glfwPollEvents();
 
 #ifdef DEBUG
-        frame_stats.pop();
-        frame_stats.push("CPU - Submit");
-        vk_core::set_latency_marker_NV(frame_counter, VK_LATENCY_MARKER_RENDERSUBMIT_START_NV);
+        vk_core::set_latency_marker_NV(frame_counter, VK_LATENCY_MARKER_SIMULATION_START_NV);
 #endif
 
-        // Submit
+        render_packet.frame_id = frame_counter;
+        render_packet.camera = {
+            .extent = {window_dim_x, window_dim_y},
+            .clear_color = {0.1f, 0.1f, 0.1f, 0.0f},
+        };
+
+        render_packet.draw_cmd_vec.clear();
+        render_packet.deferred_destroy_vec.clear();
+
+#ifdef SHADER_HOT_RELOAD
+        for (const std::string& shader_path : shader_hot_reload.take_reloaded_shaders())
+            program_reload_requested |= program_compiler.uses_shader(shader_path);
+
+        // One recompile at a time, shaders saved while it runs are picked up by the next one.
+        if (program_reload_requested && reloading_program == nullptr)
         {
-            const VkPipelineStageFlags render_submit_wait_sem4_stages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-
-            const VkLatencySubmissionPresentIdNV latency_submission_present {
-                .sType = VK_STRUCTURE_TYPE_LATENCY_SUBMISSION_PRESENT_ID_NV,
-                .pNext = nullptr,
-                .presentID = frame_counter,
-            };
-
-            const VkSubmitInfo submit_info {
-                .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-                .pNext = &latency_submission_present,
-                .waitSemaphoreCount = 0u,
-                .pWaitSemaphores = nullptr,
-                .pWaitDstStageMask = 0u,
-                .commandBufferCount = 1u,
-                .pCommandBuffers = &frame_resource.vk_handle_cmd_buff,
-                .signalSemaphoreCount = 1u,
-                .pSignalSemaphores = &frame_resource.vk_handle_render_complete_sem4,
-            };
-
-            vk_core::queue_submit(submit_info, frame_resource.vk_handle_fence);
-            // vk_core::device_wait_idle();
+            reloading_program = program_compiler.compile_async();
+            program_reload_requested = false;
         }
 
-#ifdef DEBUG
-    frame_stats.pop();
-    frame_stats.push("CPU - Present Call");
-    vk_core::set_latency_marker_NV(frame_counter, VK_LATENCY_MARKER_RENDERSUBMIT_END_NV);
-    vk_core::set_latency_marker_NV(frame_counter, VK_LATENCY_MARKER_PRESENT_START_NV);
+        // Swapped at the frame boundary. Earlier packets may still reference the old pipeline, it is
+        // destroyed once the GPU finished the frame recorded from this packet.
+        if (reloading_program != nullptr && reloading_program->is_ready())
+        {
+            render_packet.deferred_destroy_vec.push_back([retired_program = std::move(program)]() {
+                retired_program->destroy();
+            });
+
+            program = std::exchange(reloading_program, nullptr);
+
+            // The new pipelines are created and released their modules, the ones of the replaced SPIR-V are unused.
+            shader_module_cache::trim();
+        }
 #endif
 
-        // Present
+        // Pass VK_NULL_HANDLE as the fallback to skip the draw until the program is compiled instead.
+        if (const VkPipeline vk_handle_pipeline = program->get_pipeline_or(vk_handle_fallback_pipeline); vk_handle_pipeline != VK_NULL_HANDLE)
         {
-            const VkPresentIdKHR present_id_obj {
-                .sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR,
-                .pNext = nullptr,
-                .swapchainCount = 1u,
-                .pPresentIds = &frame_counter 
-            }; 
-
-            vk_core::present(next_avail_swapchain_image_idx, {frame_resource.vk_handle_render_complete_sem4}, (void*)(&present_id_obj));
+            render_packet.draw_cmd_vec.push_back({
+                .vk_handle_pipeline = vk_handle_pipeline,
+                .dynamic_state = {
+                    .cull_mode = VK_CULL_MODE_NONE,
+                    .blend_enable = enable_blend ? VK_TRUE : VK_FALSE,
+                    .blend_equation = {
+                        .srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA,
+                        .dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
+                        .colorBlendOp = VK_BLEND_OP_ADD,
+                        .srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
+                        .dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
+                        .alphaBlendOp = VK_BLEND_OP_MAX,
+                    },
+                },
+                .vertex_count = 3u,
+                .instance_count = 10000u,
+            });
         }
 
 #ifdef DEBUG
-    frame_stats.pop();
-    vk_core::set_latency_marker_NV(frame_counter, VK_LATENCY_MARKER_PRESENT_END_NV);
-#endif
+        vk_core::set_latency_marker_NV(frame_counter, VK_LATENCY_MARKER_SIMULATION_END_NV);
+
+        main_thread_stats.pop();
+        main_thread_stats.push("CPU - Main Thread - UI");
 
-#if 0
         {
-            for (uint32_t i = 0; i < frame_latency_timing_array.size(); i++)
+            ImGui_ImplVulkan_NewFrame();
+            ImGui_ImplGlfw_NewFrame();
+            ImGui::NewFrame();
+
+            frame_id_vec.clear();
+            cpu_data_vec.clear();
+            gpu_data_vec.clear();
+
+            FrameStatsReport report;
+
+            while (frame_stats_report_queue.try_pop(report))
             {
-                frame_latency_timing_array[i].sType = VK_STRUCTURE_TYPE_LATENCY_TIMINGS_FRAME_REPORT_NV;
-                frame_latency_timing_array[i].pNext = nullptr;
-                frame_latency_timing_array[i].presentID = 0u;
+                frame_id_vec.push_back(report.frame_id);
+                cpu_data_vec.push_back(report.cpu_data);
+                gpu_data_vec.push_back({});
+                gpu_data_vec.back().push_back({});
+                gpu_data_vec.back().front().first = "GPU";
+                gpu_data_vec.back().front().second = report.gpu_data;
+
+                for (const auto& [name, value] : report.counter_data)
+                    counter_total_map[name] += value;
             }
 
-            VkGetLatencyMarkerInfoNV latency_marker_info {
-                .sType = VK_STRUCTURE_TYPE_GET_LATENCY_MARKER_INFO_NV,
-                .pNext = nullptr,
-                .timingCount = static_cast<uint32_t>(frame_latency_timing_array.size()),
-                .pTimings = frame_latency_timing_array.data(),
-            };
+            for (const auto& [name, total] : counter_total_map)
+                ImGui::Text("%s: %" PRIu64, name.c_str(), total);
 
-            vk_core::get_latency_timings_NV(&latency_marker_info);
+            // Kept for the whole session, pipelines are only created once.
+            main_thread_stats.add_pipeline_creations(vk_core::take_pipeline_creation_feedback());
+            const auto& new_pipeline_creation_vec = main_thread_stats.get_pipeline_creation_data();
+            pipeline_creation_vec.insert(pipeline_creation_vec.end(), new_pipeline_creation_vec.begin(), new_pipeline_creation_vec.end());
 
-            const uint64_t zero_tick = frame_latency_timing_array.front().inputSampleTimeUs;
+            ImGui::Begin("Pipelines");
+            imgui_wrapper::pipeline_creation_table(pipeline_creation_vec);
+            ImGui::End();
 
-            for (const auto& frame_latency_timings : frame_latency_timing_array)
+            if (!frame_id_vec.empty())
             {
-                std::cout << frame_counter << " " << frame_latency_timings.presentID << '\n';
-                print_stats("\tSimTime     ", frame_latency_timings.simStartTimeUs, frame_latency_timings.simEndTimeUs, zero_tick, gpu_timestamp_period);
-                print_stats("\tRenderSubmit", frame_latency_timings.renderSubmitStartTimeUs, frame_latency_timings.renderSubmitEndTimeUs, zero_tick, gpu_timestamp_period);
-                print_stats("\tGPURender   ", frame_latency_timings.gpuRenderStartTimeUs, frame_latency_timings.gpuRenderEndTimeUs, zero_tick, gpu_timestamp_period);
-                print_stats("\tPresent     ", frame_latency_timings.presentStartTimeUs, frame_latency_timings.presentEndTimeUs, zero_tick, gpu_timestamp_period);
-                // print_stats("Driver      ", frame_latency_timings.driverStartTimeUs, frame_latency_timings.driverEndTimeUs, zero_tick, gpu_timestamp_period);
-                print_stats("\tOsRenderQ   ", frame_latency_timings.osRenderQueueStartTimeUs, frame_latency_timings.osRenderQueueEndTimeUs, zero_tick, gpu_timestamp_period);
-                std::cout << '\n';
+                std::cout << "\n0 - Prev Frame Start      : " << cpu_data_vec.back().front().second[0] << '\n';
+                std::cout <<   "0 - Prev Frame Query Start: " << gpu_data_vec.back().front().second[0] << '\n';
+                std::cout <<   "0 - Prev Frame Query End  : " << gpu_data_vec.back().front().second[1] << '\n';
+                std::cout <<   "0 - Prev Frame End        : " << cpu_data_vec.back().front().second[1] << '\n';
+
+                const uint64_t divider = 1000;
+                const uint64_t zero_tick = cpu_data_vec.back().front().second[0];
+
+                std::cout << "1 - Prev Frame Start      : " << ((cpu_data_vec.back().front().second[0]) - zero_tick)  / divider << '\n';
+                std::cout << "1 - Prev Frame Query Start: " << (((gpu_data_vec.back().front().second[0])     ) - zero_tick)  / divider << '\n';
+                std::cout << "1 - Prev Frame Query End  : " << (((gpu_data_vec.back().front().second[1])     ) - zero_tick)  / divider << '\n';
+                std::cout << "1 - Prev Frame End        : " << ((cpu_data_vec.back().front().second[1]) - zero_tick)  / divider << '\n';
             }
+
+            test_gui(frame_id_vec, cpu_data_vec, gpu_data_vec);
+
+            // ImPlot::ShowDemoWindow();
+
+            ImGui::Render();
+            render_packet.ui_draw_data.copy(ImGui::GetDrawData());
         }
-#endif
 
-#ifdef DEBUG
-        frame_stats.pop();
-        frame_stats_vec[active_frame_res_idx] = frame_stats;
-        frame_gpu_query_data_vec[active_frame_res_idx] = frame_gpu_query_data;
+        main_thread_stats.pop();
+        render_packet.main_thread_cpu_data = main_thread_stats.get_cpu_data();
 #endif
+
+        // Blocks while the render thread has not picked up the previous packet.
+        render_packet_buffer.publish();
+
         frame_counter++;
+        pipeline_warmup::next_frame();
     }
 
+    render_packet_buffer.close();
+    render_thread.join();
+
+    if (use_present_thread)
+        present_thread.stop();
+
     vk_core::queue_wait_idle();
+    vk_core::run_deferred_destructions();
 
     for (auto& frame_resource : frame_resource_vec)
     {
         vk_core::destroy_command_pool(frame_resource.vk_handle_cmd_pool);
+        frame_resource.desc_allocator.destroy();
+        frame_resource.desc_buffer_allocator.destroy();
         vk_core::destroy_fence(frame_resource.vk_handle_fence);
         vk_core::destroy_semaphore(frame_resource.vk_handle_render_complete_sem4);
         vk_core::destroy_semaphore(frame_resource.vk_handle_swapchain_image_acquire_sem4);
     }
 
-    vk_core::destroy_pipeline_layout(vk_handle_pipeline_layout);
-    vk_core::destroy_pipeline(vk_handle_pipeline);
+#ifdef SHADER_HOT_RELOAD
+    shader_hot_reload.stop();
+#endif
+
+    pipeline_compile_workers::stop();
+
+#ifdef SHADER_HOT_RELOAD
+    if (reloading_program != nullptr)
+        reloading_program->destroy();
+#endif
+
+    pipeline_warmup::save();
+
+    for (const std::shared_ptr<AsyncGraphicsProgram>& warmup_program : warmup_program_vec)
+        warmup_program->destroy();
+
+    program->destroy();
+    fallback_program->destroy();
+    Compiler_GraphicsProgram::destroy_pipeline_library_cache();
+    desc_update_template_cache::destroy();
+    pipeline_layout_cache::destroy();
+    bindless_table::destroy();
+    object_cache::destroy();
+    shader_module_cache::destroy();
+    shader_archive::close();
     vk_core::destroy_fence(vk_handle_swapchain_image_acquire_fence);
-    
+
     imgui_wrapper::destroy();
 
     vk_core::terminate();
@@ -843,4 +1174,4 @@ int main()
     glfwTerminate();
 
     return 0;
-}
\ No newline at end of file
+}
@@ -1,2 +0,0 @@
-${VULKAN_SDK}/bin/glslc glsl/default.vert -o spirv/default.vert.spv
-${VULKAN_SDK}/bin/glslc glsl/default.frag -o spirv/default.frag.spv
\ No newline at end of file
@@ -1,7 +1,9 @@
 #version 450
 
+layout(constant_id = 0) const bool translucent = false;
+
 layout(location = 0) out vec4 out_color;
 
 void main() {
-    out_color = vec4(0.01, 0.72, 0.43, 1.0);
+    out_color = vec4(0.01, 0.72, 0.43, translucent ? 0.5 : 1.0);
 }
\ No newline at end of file
@@ -3,11 +3,18 @@
 #include "imgui_impl_vulkan.h"
 #include "implot.h"
 
+#include "vk_core.hpp"
+
+#include <vector>
+
 class GLFWwindow;
 
 namespace imgui_wrapper
 {
     void init(GLFWwindow* glfw_window, VkFormat color_attachment_format);
 
+    // Sortable table of pipeline creation times and pipeline cache hits, call between Begin / End.
+    void pipeline_creation_table(const std::vector<vk_core::PipelineCreationFeedback>& feedback_vec);
+
     void destroy();
 };
\ No newline at end of file
@@ -1,7 +1,10 @@
 #include "imgui_wrapper.hpp"
 
 #include "vk_core.hpp"
+#include <algorithm>
 #include <array>
+#include <numeric>
+#include <string>
 
 namespace
 {
@@ -35,6 +38,46 @@ namespace
 
         vk_handle_desc_pool = vk_core::create_desc_pool(pool_create_info);
     }
+
+    enum PipelineCreationColumn : ImGuiID
+    {
+        Name = 0,
+        Duration,
+        CacheHit,
+        Stages,
+    };
+
+    double get_duration_ms(const VkPipelineCreationFeedback& feedback)
+    {
+        return (feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT) ? static_cast<double>(feedback.duration) / 1000000.0 : 0.0;
+    }
+
+    bool is_cache_hit(const VkPipelineCreationFeedback& feedback)
+    {
+        return (feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT) != 0x0;
+    }
+
+    const char* get_stage_name(VkShaderStageFlagBits stage)
+    {
+        switch (stage)
+        {
+            case VK_SHADER_STAGE_VERTEX_BIT: return "vert";
+            case VK_SHADER_STAGE_GEOMETRY_BIT: return "geom";
+            case VK_SHADER_STAGE_FRAGMENT_BIT: return "frag";
+            case VK_SHADER_STAGE_COMPUTE_BIT: return "comp";
+            default: return "other";
+        }
+    }
+
+    bool compare_pipeline_creations(const vk_core::PipelineCreationFeedback& lhs, const vk_core::PipelineCreationFeedback& rhs, ImGuiID column)
+    {
+        switch (column)
+        {
+            case Duration: return get_duration_ms(lhs.pipeline) < get_duration_ms(rhs.pipeline);
+            case CacheHit: return is_cache_hit(lhs.pipeline) < is_cache_hit(rhs.pipeline);
+            default: return lhs.name < rhs.name;
+        }
+    }
 };
 
 namespace imgui_wrapper
@@ -82,6 +125,68 @@ namespace imgui_wrapper
     }
 
 
+    void pipeline_creation_table(const std::vector<vk_core::PipelineCreationFeedback>& feedback_vec)
+    {
+        constexpr ImGuiTableFlags table_flags = ImGuiTableFlags_Sortable | ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg |
+            ImGuiTableFlags_Borders | ImGuiTableFlags_ScrollY;
+
+        if (!ImGui::BeginTable("Pipeline Creation", 4, table_flags, ImVec2(0.0f, 300.0f)))
+            return;
+
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Program", ImGuiTableColumnFlags_WidthStretch, 0.0f, Name);
+        ImGui::TableSetupColumn("Total (ms)", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_PreferSortDescending, 0.0f, Duration);
+        ImGui::TableSetupColumn("Cache Hit", 0x0, 0.0f, CacheHit);
+        ImGui::TableSetupColumn("Stages (ms)", ImGuiTableColumnFlags_NoSort | ImGuiTableColumnFlags_WidthStretch, 0.0f, Stages);
+        ImGui::TableHeadersRow();
+
+        // Sorted every frame, there are at most a few hundred pipelines.
+        std::vector<size_t> row_vec(feedback_vec.size());
+        std::iota(row_vec.begin(), row_vec.end(), 0u);
+
+        if (const ImGuiTableSortSpecs* sort_specs = ImGui::TableGetSortSpecs(); sort_specs != nullptr && sort_specs->SpecsCount > 0)
+        {
+            const ImGuiTableColumnSortSpecs& column_specs = sort_specs->Specs[0];
+
+            std::stable_sort(row_vec.begin(), row_vec.end(), [&](size_t lhs, size_t rhs) {
+                return (column_specs.SortDirection == ImGuiSortDirection_Ascending)
+                    ? compare_pipeline_creations(feedback_vec[lhs], feedback_vec[rhs], column_specs.ColumnUserID)
+                    : compare_pipeline_creations(feedback_vec[rhs], feedback_vec[lhs], column_specs.ColumnUserID);
+            });
+        }
+
+        for (const size_t row : row_vec)
+        {
+            const vk_core::PipelineCreationFeedback& feedback = feedback_vec[row];
+            std::string stage_text;
+
+            for (const auto& [stage, stage_feedback] : feedback.stage_vec)
+            {
+                stage_text += std::string(stage_text.empty() ? "" : "  ") + get_stage_name(stage) + " " + std::to_string(get_duration_ms(stage_feedback)).substr(0, 5);
+
+                if (is_cache_hit(stage_feedback))
+                    stage_text += " (hit)";
+            }
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(feedback.name.c_str());
+            ImGui::TableNextColumn();
+
+            if (feedback.pipeline.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT)
+                ImGui::Text("%.3f", get_duration_ms(feedback.pipeline));
+            else
+                ImGui::TextUnformatted("-");
+
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(is_cache_hit(feedback.pipeline) ? "yes" : "no");
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(stage_text.c_str());
+        }
+
+        ImGui::EndTable();
+    }
+
     void destroy()
     {
         ImGui_ImplVulkan_Shutdown();
@@ -3,9 +3,12 @@
 
 #include <vulkan/vulkan.h>
 
+#include <string>
 #include <string_view>
 #include <vector>
 #include <optional>
+#include <functional>
+#include <type_traits>
 
 class GLFWwindow;
 
@@ -37,10 +40,12 @@ namespace vk_core
         void* device_pnext_chain;
         std::vector<const char*> device_layers;
         std::vector<const char*> device_extensions;
+        std::vector<const char*> optional_device_extensions; // enabled if supported, see is_device_extension_enabled
         VkFormat swapchain_image_format;
         uint32_t swapchain_min_image_count;
         VkExtent2D swapchain_image_extent;
         VkPresentModeKHR swapchain_present_mode;
+        const char* pipeline_cache_path;                     // loaded by init and saved by terminate, nullptr to not persist the cache
     };
 
     void init(const InitInfo& init_info);
@@ -50,8 +55,10 @@ namespace vk_core
     VkPhysicalDevice get_physical_device();
     VkDevice get_device();
     VkQueue get_queue();
+    bool is_device_extension_enabled(const char* extension_name);
     uint32_t get_queue_family_idx();
     int32_t get_swapchain_image_count();
+    uint32_t get_max_acquired_swapchain_image_count();
     VkImage get_swapchain_image(int32_t idx);
 
 
@@ -64,8 +71,79 @@ namespace vk_core
     void device_wait_idle();
 
     void queue_submit(const VkSubmitInfo& submit_info, VkFence vk_handle_signal_fence = VK_NULL_HANDLE);
+    void queue_submit(const uint32_t submit_count, const VkSubmitInfo* const p_submit_infos, const VkFence vk_handle_signal_fence = VK_NULL_HANDLE);
+    void queue_submit2(const uint32_t submit_count, const VkSubmitInfo2* const p_submit_infos, const VkFence vk_handle_signal_fence = VK_NULL_HANDLE);
     void queue_wait_idle();
 
+    // Submission Batching
+    //
+    // Submits are enqueued (from any thread) and handed to the driver in a single vkQueueSubmit2 call
+    // by flush_submit_batch. Every flush also signals the vk_core submit timeline semaphore, the returned
+    // value can be waited on with wait_for_timeline_value.
+    // The p_next chain passed to enqueue_submit must stay alive until the batch is flushed.
+
+    VkSemaphoreSubmitInfo semaphore_submit_info(VkSemaphore vk_handle_sem4, VkPipelineStageFlags2 stage_mask, uint64_t value = 0u);
+    void enqueue_submit(std::vector<VkCommandBuffer>&& vk_handle_cmd_buff_vec, std::vector<VkSemaphoreSubmitInfo>&& wait_sem4_vec = {}, std::vector<VkSemaphoreSubmitInfo>&& signal_sem4_vec = {}, const void* p_next = nullptr);
+    uint64_t flush_submit_batch(VkFence vk_handle_signal_fence = VK_NULL_HANDLE);
+
+    VkSemaphore create_timeline_semaphore(uint64_t initial_value = 0u);
+    uint64_t get_submit_timeline_value();
+    uint64_t get_completed_timeline_value();
+    // Returns false if the timeout expired before the timeline reached value.
+    bool wait_for_timeline_value(uint64_t value, uint64_t timeout);
+    bool is_timeline_value_complete(uint64_t value);
+
+    // Immediate Submission
+    //
+    // record_func records into a pooled primary command buffer which is submitted right away. The returned
+    // submit timeline value is the ticket for that work - wait on it (or poll it) before using the results.
+    // Work on the same queue that is submitted later is ordered after it, so layout transitions and uploads
+    // only need a pipeline barrier, not a wait.
+
+    uint64_t immediate_submit(const std::function<void(VkCommandBuffer)>& record_func);
+
+    // Recycling Pools
+    //
+    // Pooled objects are handed out ready to use (fences unsignaled, command buffers reset) and are given
+    // back together with the submit timeline value of the last work using them (e.g. the value returned by
+    // flush_submit_batch for the owning frame). They are recycled once the timeline reaches that value.
+    // Released fences must have a pending signal operation. Command buffers come from a command pool owned
+    // by the acquiring thread, but can be released from any thread.
+    //
+    // Semaphores are only recycled if a submit or present waited on them after they were acquired. Others
+    // may still have a pending signal (e.g. from an acquire that ended in VK_ERROR_OUT_OF_DATE_KHR) and are
+    // held back until drop_unwaited_pooled_semaphores, call it on swapchain recreation once the device is idle.
+
+    struct PoolStats
+    {
+        uint32_t capacity;        // objects created by the pool
+        uint32_t in_use;          // acquired and not yet recycled
+        uint32_t high_water_mark; // peak of in_use, use it to size reserve_pools
+    };
+
+    void reserve_pools(uint32_t fence_count, uint32_t sem4_count, uint32_t cmd_buff_count);
+
+    VkFence acquire_pooled_fence();
+    VkSemaphore acquire_pooled_semaphore();
+    VkCommandBuffer acquire_pooled_command_buffer();
+    void release_pooled_fence(VkFence vk_handle_fence, uint64_t timeline_value);
+    void release_pooled_semaphore(VkSemaphore vk_handle_sem4, uint64_t timeline_value);
+    void release_pooled_command_buffer(VkCommandBuffer vk_handle_cmd_buff, uint64_t timeline_value);
+    void drop_unwaited_pooled_semaphores();
+
+    PoolStats get_fence_pool_stats();
+    PoolStats get_semaphore_pool_stats();
+    PoolStats get_command_buffer_pool_stats();
+
+    // Deferred Destruction
+    //
+    // destroy_func runs once the submit timeline reaches timeline_value, e.g. for objects that were replaced
+    // while frames using them are still in flight. run_deferred_destructions is meant to be called once per
+    // frame, terminate runs whatever is left.
+
+    void defer_destruction(uint64_t timeline_value, std::function<void()>&& destroy_func);
+    void run_deferred_destructions();
+
     void destroy_semaphore(VkSemaphore vk_handle_sem4);
 
     void wait_for_fence(VkFence vk_handle_fence, uint64_t timeout);
@@ -80,6 +158,8 @@ namespace vk_core
     void end_command_buffer(VkCommandBuffer vk_handle_cmd_buff);
 
     VkDescriptorPool create_desc_pool(const VkDescriptorPoolCreateInfo& create_info);
+    // Returns every set allocated from the pool to it at once.
+    void reset_desc_pool(VkDescriptorPool vk_handle_desc_pool);
     void destroy_desc_pool(VkDescriptorPool vk_handle_desc_pool);
 
     VkPipelineLayout create_pipeline_layout(const VkPipelineLayoutCreateInfo& create_info);
@@ -97,16 +177,46 @@ namespace vk_core
     void destroy_fence(const VkFence vk_handle_fence);
 
     const VkPhysicalDeviceProperties& get_physical_device_properties();
+    const VkPhysicalDeviceSubgroupSizeControlProperties& get_physical_device_subgroup_size_control_properties();
+    // Features enabled through InitInfo::device_pnext_chain (VkPhysicalDeviceVulkan13Features or the standalone struct).
+    const VkPhysicalDeviceSubgroupSizeControlFeatures& get_enabled_subgroup_size_control_features();
+    const VkPhysicalDeviceDescriptorIndexingProperties& get_physical_device_descriptor_indexing_properties();
+    const VkPhysicalDeviceDescriptorBufferPropertiesEXT& get_physical_device_descriptor_buffer_properties();
+    const VkPhysicalDevicePushDescriptorPropertiesKHR& get_physical_device_push_descriptor_properties();
 
     void debug_utils_begin_label(VkCommandBuffer vk_handle_cmd_buff, const char* name);
     void debug_utils_end_label(VkCommandBuffer vk_handle_cmd_buff);
 
+    // Core dynamic state, the matching VK_DYNAMIC_STATE_* has to be set on the bound pipeline.
+    void cmd_set_viewport(VkCommandBuffer vk_handle_cmd_buff, uint32_t first_viewport, const std::vector<VkViewport>& viewport_vec);
+    void cmd_set_scissor(VkCommandBuffer vk_handle_cmd_buff, uint32_t first_scissor, const std::vector<VkRect2D>& scissor_vec);
+    void cmd_set_viewport_with_count(VkCommandBuffer vk_handle_cmd_buff, const std::vector<VkViewport>& viewport_vec);
+    void cmd_set_scissor_with_count(VkCommandBuffer vk_handle_cmd_buff, const std::vector<VkRect2D>& scissor_vec);
+    void cmd_set_cull_mode(VkCommandBuffer vk_handle_cmd_buff, VkCullModeFlags cull_mode);
+    void cmd_set_front_face(VkCommandBuffer vk_handle_cmd_buff, VkFrontFace front_face);
+    void cmd_set_depth_test_enable(VkCommandBuffer vk_handle_cmd_buff, VkBool32 test_enable);
+    void cmd_set_depth_write_enable(VkCommandBuffer vk_handle_cmd_buff, VkBool32 write_enable);
+    void cmd_set_depth_compare_op(VkCommandBuffer vk_handle_cmd_buff, VkCompareOp compare_op);
+
+    // VK_EXT_extended_dynamic_state3 color blend state, no-ops when the extension is not enabled.
+    void cmd_set_color_blend_enable_EXT(VkCommandBuffer vk_handle_cmd_buff, uint32_t first_attachment, const std::vector<VkBool32>& blend_enable_vec);
+    void cmd_set_color_blend_equation_EXT(VkCommandBuffer vk_handle_cmd_buff, uint32_t first_attachment, const std::vector<VkColorBlendEquationEXT>& blend_equation_vec);
+    void cmd_set_color_write_mask_EXT(VkCommandBuffer vk_handle_cmd_buff, uint32_t first_attachment, const std::vector<VkColorComponentFlags>& write_mask_vec);
+
+    // VK_EXT_descriptor_buffer, only valid when is_device_extension_enabled(VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME).
+    VkDeviceSize get_desc_set_layout_size_EXT(VkDescriptorSetLayout vk_handle_desc_set_layout);
+    VkDeviceSize get_desc_set_layout_binding_offset_EXT(VkDescriptorSetLayout vk_handle_desc_set_layout, uint32_t binding);
+    void get_descriptor_EXT(const VkDescriptorGetInfoEXT& descriptor_get_info, size_t descriptor_size, void* p_descriptor);
+    void cmd_bind_desc_buffers_EXT(VkCommandBuffer vk_handle_cmd_buff, const std::vector<VkDescriptorBufferBindingInfoEXT>& binding_info_vec);
+    void cmd_set_desc_buffer_offsets_EXT(VkCommandBuffer vk_handle_cmd_buff, VkPipelineBindPoint bind_point, VkPipelineLayout vk_handle_pipeline_layout, uint32_t first_set, uint32_t set_count, const uint32_t* p_buffer_indices, const VkDeviceSize* p_offsets);
+
     void get_latency_timings_NV(VkGetLatencyMarkerInfoNV* latency_marker_info);
     void set_latency_marker_NV(uint64_t present_id, VkLatencyMarkerNV marker);
 
     // Resource Management
 
     VkSampler create_sampler(const VkSamplerCreateInfo& create_info);
+    void destroy_sampler(const VkSampler vk_handle_sampler);
 
     VkImage create_image(const VkImageCreateInfo& create_info);
     VkImageView create_image_view(const VkImageViewCreateInfo& create_info);
@@ -116,9 +226,12 @@ namespace vk_core
     void destroy_image_view(const VkImageView vk_handle_image_view);
 
     VkBuffer create_buffer(const VkBufferCreateInfo& create_info);
-    VkDeviceMemory allocate_buffer_memory(const VkBuffer vk_handle_buffer, const VkMemoryPropertyFlags flags, VkDeviceSize& size);
+    // Buffers read through their device address need VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT and memory
+    // allocated with VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT in allocate_flags.
+    VkDeviceMemory allocate_buffer_memory(const VkBuffer vk_handle_buffer, const VkMemoryPropertyFlags flags, VkDeviceSize& size, const VkMemoryAllocateFlags allocate_flags = 0x0);
     void bind_buffer_memory(const VkBuffer vk_handle_buffer, const VkDeviceMemory vk_handle_buffer_memory); 
     void destroy_buffer(const VkBuffer vk_handle_buffer);
+    VkDeviceAddress get_buffer_device_address(const VkBuffer vk_handle_buffer);
 
     void map_memory(const VkDeviceMemory memory, const VkDeviceSize offset, const VkDeviceSize size, const VkMemoryMapFlags flags, void** data);
     void unmap_memory(const VkDeviceMemory vk_handle_memory);
@@ -127,17 +240,59 @@ namespace vk_core
     VkShaderModule create_shader_module(const VkShaderModuleCreateInfo& create_info);
     void destroy_shader_module(const VkShaderModule vk_handle_shader_module);
 
-    VkPipeline create_graphics_pipeline(const VkGraphicsPipelineCreateInfo& create_info);
+    // All pipelines are created through one VkPipelineCache, see InitInfo::pipeline_cache_path. The name
+    // tags the pipeline's creation feedback.
+    VkPipeline create_graphics_pipeline(const VkGraphicsPipelineCreateInfo& create_info, const char* name = nullptr);
+    // One driver call for the whole batch. Does not assert, pipelines that failed are VK_NULL_HANDLE and
+    // the result is the error of one of them. p_names has create_info_count entries or is nullptr.
+    VkResult create_graphics_pipelines(const uint32_t create_info_count, const VkGraphicsPipelineCreateInfo* const p_create_infos, VkPipeline* const p_pipelines, const char* const* p_names = nullptr);
+    VkPipeline create_compute_pipeline(const VkComputePipelineCreateInfo& create_info, const char* name = nullptr);
     void destroy_pipeline(const VkPipeline vk_handle_pipeline);
 
+    // Pipeline Creation Feedback
+    //
+    // Durations and cache hits the driver reports for every pipeline vk_core creates. Only kept while
+    // recording is enabled, take_pipeline_creation_feedback hands over what was recorded since the last call.
+
+    struct PipelineCreationFeedback
+    {
+        std::string name;
+        VkPipelineCreationFeedback pipeline;
+        std::vector<std::pair<VkShaderStageFlagBits, VkPipelineCreationFeedback>> stage_vec;
+    };
+
+    void set_pipeline_creation_feedback_recording(bool enable);
+    std::vector<PipelineCreationFeedback> take_pipeline_creation_feedback();
+
 
 
     VkDescriptorSetLayout create_desc_set_layout(const VkDescriptorSetLayoutCreateInfo& create_info);
     void destroy_desc_set_layout(const VkDescriptorSetLayout vk_handle_desc_set_layout);
 
     std::vector<VkDescriptorSet> allocate_desc_sets(const VkDescriptorSetAllocateInfo& alloc_info);
+    // Does not assert, VK_ERROR_OUT_OF_POOL_MEMORY / VK_ERROR_FRAGMENTED_POOL mean the caller needs another pool.
+    VkResult allocate_desc_sets(const VkDescriptorSetAllocateInfo& alloc_info, VkDescriptorSet* p_desc_sets);
     void update_desc_sets(const uint32_t update_count, const VkWriteDescriptorSet* const p_write_desc_set_list, const uint32_t copy_count, const VkCopyDescriptorSet* const p_copy_desc_set_list);
 
+    VkDescriptorUpdateTemplate create_desc_update_template(const VkDescriptorUpdateTemplateCreateInfo& create_info);
+    void destroy_desc_update_template(VkDescriptorUpdateTemplate vk_handle_desc_update_template);
+    // p_data is laid out as the template's entries describe.
+    void update_desc_set_with_template(VkDescriptorSet vk_handle_desc_set, VkDescriptorUpdateTemplate vk_handle_desc_update_template, const void* p_data);
+
+    void cmd_push_constants(VkCommandBuffer vk_handle_cmd_buff, VkPipelineLayout vk_handle_pipeline_layout, VkShaderStageFlags stage_flags, uint32_t offset, uint32_t size, const void* p_values);
+
+    // values is laid out like the shader's push constant block from offset on.
+    template<typename T>
+    void cmd_push_constants(VkCommandBuffer vk_handle_cmd_buff, VkPipelineLayout vk_handle_pipeline_layout, VkShaderStageFlags stage_flags, const T& values, uint32_t offset = 0u)
+    {
+        static_assert(std::is_trivially_copyable_v<T> && sizeof(T) % 4u == 0u, "push constants have to be a plain struct of 4 byte multiples");
+        cmd_push_constants(vk_handle_cmd_buff, vk_handle_pipeline_layout, stage_flags, offset, sizeof(T), &values);
+    }
+
+    // VK_KHR_push_descriptor, set has to be created with VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR.
+    // dstSet of the writes is ignored.
+    void cmd_push_descriptor_set_KHR(VkCommandBuffer vk_handle_cmd_buff, VkPipelineBindPoint bind_point, VkPipelineLayout vk_handle_pipeline_layout, uint32_t set, const std::vector<VkWriteDescriptorSet>& write_desc_set_vec);
+
 
     // Events
 
@@ -6,10 +6,18 @@
 #include "json.hpp"
 
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
 #include <fstream>
 #include <vector>
+#include <string>
 #include <algorithm>
+#include <mutex>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <atomic>
+#include <utility>
 
 #define LOG(fmt, ...)                    \
     fprintf(stdout, fmt, ##__VA_ARGS__); \
@@ -98,6 +106,22 @@ static VkPhysicalDevice select_physical_device(VkInstance vk_handle_instance, ui
     return physical_device_vec[physical_device_ID];
 }
 
+static bool device_extension_supported(VkPhysicalDevice vk_handle_physical_device, const char* extension_name)
+{
+    uint32_t count = 0u;
+    vkEnumerateDeviceExtensionProperties(vk_handle_physical_device, nullptr, &count, nullptr);
+    std::vector<VkExtensionProperties> extension_props_vec(count);
+    vkEnumerateDeviceExtensionProperties(vk_handle_physical_device, nullptr, &count, extension_props_vec.data());
+
+    for (const auto& extension_props : extension_props_vec)
+    {
+        if (strcmp(extension_props.extensionName, extension_name) == 0)
+            return true;
+    }
+
+    return false;
+}
+
 static uint32_t select_queue_family_index(VkPhysicalDevice vk_handle_physical_device, VkSurfaceKHR vk_handle_surface, VkQueueFlags queue_flags, bool queue_needs_present)
 {
     uint32_t count = 0u;
@@ -374,20 +398,190 @@ static PFN_vkSetDebugUtilsObjectNameEXT vkSetDebugUtilsObjectNameEXT = VK_NULL_H
 static PFN_vkCmdBeginDebugUtilsLabelEXT vkCmdBeginDebugUtilsLabelEXT = VK_NULL_HANDLE;;
 static PFN_vkCmdEndDebugUtilsLabelEXT vkCmdEndDebugUtilsLabelEXT = VK_NULL_HANDLE;
 static PFN_vkGetCalibratedTimestampsKHR vkGetCalibratedTimestampsKHR = VK_NULL_HANDLE;
+static PFN_vkCmdSetColorBlendEnableEXT vkCmdSetColorBlendEnableEXT = VK_NULL_HANDLE;
+static PFN_vkCmdSetColorBlendEquationEXT vkCmdSetColorBlendEquationEXT = VK_NULL_HANDLE;
+static PFN_vkCmdSetColorWriteMaskEXT vkCmdSetColorWriteMaskEXT = VK_NULL_HANDLE;
+static PFN_vkGetDescriptorSetLayoutSizeEXT vkGetDescriptorSetLayoutSizeEXT = VK_NULL_HANDLE;
+static PFN_vkGetDescriptorSetLayoutBindingOffsetEXT vkGetDescriptorSetLayoutBindingOffsetEXT = VK_NULL_HANDLE;
+static PFN_vkGetDescriptorEXT vkGetDescriptorEXT = VK_NULL_HANDLE;
+static PFN_vkCmdBindDescriptorBuffersEXT vkCmdBindDescriptorBuffersEXT = VK_NULL_HANDLE;
+static PFN_vkCmdSetDescriptorBufferOffsetsEXT vkCmdSetDescriptorBufferOffsetsEXT = VK_NULL_HANDLE;
+static PFN_vkCmdPushDescriptorSetKHR vkCmdPushDescriptorSetKHR = VK_NULL_HANDLE;
 
 static VkInstance vk_handle_instance = VK_NULL_HANDLE;
 static VkSurfaceKHR vk_handle_surface = VK_NULL_HANDLE;
 static VkPhysicalDevice vk_handle_physical_device = VK_NULL_HANDLE;
 static VkPhysicalDeviceProperties vk_phys_dev_props;
+static VkPhysicalDeviceSubgroupSizeControlProperties vk_phys_dev_subgroup_size_control_props;
+static VkPhysicalDeviceSubgroupSizeControlFeatures vk_enabled_subgroup_size_control_features;
+static VkPhysicalDeviceDescriptorIndexingProperties vk_phys_dev_desc_indexing_props;
+static VkPhysicalDeviceDescriptorBufferPropertiesEXT vk_phys_dev_desc_buffer_props;
+static VkPhysicalDevicePushDescriptorPropertiesKHR vk_phys_dev_push_desc_props;
 static VkPhysicalDeviceMemoryProperties vk_phys_dev_mem_props;
 static VkDevice vk_handle_device = VK_NULL_HANDLE;
 static VkQueue vk_handle_queue = VK_NULL_HANDLE;
 static uint32_t queue_family_idx = 0u;
 static VkSwapchainKHR vk_handle_swapchain = VK_NULL_HANDLE;
 static std::vector<VkImage> vk_handle_swapchain_image_vec;
+static uint32_t surface_min_image_count = 0u;
 static std::vector<VkImageView> vk_handle_swapchain_image_view_vec;
 static VkFormat vk_format_swapchain_image = VK_FORMAT_UNDEFINED;
 static uint32_t active_swapchain_image_idx = 0u;
+static std::vector<std::string> enabled_device_extension_vec;
+static VkPipelineCache vk_handle_pipeline_cache = VK_NULL_HANDLE;
+static std::string pipeline_cache_path;
+
+static std::mutex pipeline_creation_feedback_mutex;
+static bool record_pipeline_creation_feedback = false;
+static std::vector<PipelineCreationFeedback> pipeline_creation_feedback_vec;
+
+// vkQueueSubmit* / vkQueuePresentKHR / vkQueueWaitIdle / vkDeviceWaitIdle require external synchronization of the queue.
+static std::mutex queue_mutex;
+static VkSemaphore vk_handle_submit_timeline_sem4 = VK_NULL_HANDLE;
+static uint64_t submit_timeline_value = 0u;
+
+struct BatchedSubmit
+{
+    std::vector<VkSemaphoreSubmitInfo> wait_sem4_vec;
+    std::vector<VkCommandBufferSubmitInfo> cmd_buff_vec;
+    std::vector<VkSemaphoreSubmitInfo> signal_sem4_vec;
+    const void* p_next;
+};
+
+static std::mutex submit_batch_mutex;
+static std::vector<BatchedSubmit> submit_batch_vec;
+
+template<typename T>
+struct RecyclingPool
+{
+    std::mutex mutex;
+    std::vector<T> free_vec;
+    std::vector<std::pair<uint64_t, T>> retired_vec;
+    uint32_t capacity = 0u;
+    uint32_t high_water_mark = 0u;
+
+    // recycle_func resets a retired object and returns false if it can not be reused yet.
+    template<typename CreateFunc, typename RecycleFunc>
+    T acquire(uint64_t completed_value, CreateFunc&& create_func, RecycleFunc&& recycle_func)
+    {
+        std::lock_guard<std::mutex> pool_lock(mutex);
+
+        if (free_vec.empty())
+        {
+            std::erase_if(retired_vec, [&](const std::pair<uint64_t, T>& retired) {
+                if (retired.first > completed_value || !recycle_func(retired.second))
+                    return false;
+
+                free_vec.push_back(retired.second);
+                return true;
+            });
+        }
+
+        T handle;
+
+        if (free_vec.empty())
+        {
+            handle = create_func();
+            capacity++;
+        }
+        else
+        {
+            handle = free_vec.back();
+            free_vec.pop_back();
+        }
+
+        high_water_mark = std::max(high_water_mark, capacity - static_cast<uint32_t>(free_vec.size()));
+        return handle;
+    }
+
+    template<typename CreateFunc>
+    void reserve(uint32_t count, CreateFunc&& create_func)
+    {
+        std::lock_guard<std::mutex> pool_lock(mutex);
+
+        for (; capacity < count; capacity++)
+            free_vec.push_back(create_func());
+    }
+
+    void release(T handle, uint64_t timeline_value)
+    {
+        std::lock_guard<std::mutex> pool_lock(mutex);
+        retired_vec.push_back({timeline_value, handle});
+    }
+
+    // The caller destroyed count handles that were handed out by the pool.
+    void forget(uint32_t count)
+    {
+        std::lock_guard<std::mutex> pool_lock(mutex);
+        capacity -= count;
+    }
+
+    PoolStats get_stats()
+    {
+        std::lock_guard<std::mutex> pool_lock(mutex);
+        return {capacity, capacity - static_cast<uint32_t>(free_vec.size()), high_water_mark};
+    }
+
+    template<typename DestroyFunc>
+    void clear(DestroyFunc&& destroy_func)
+    {
+        std::lock_guard<std::mutex> pool_lock(mutex);
+
+        for (const T handle : free_vec)
+            destroy_func(handle);
+        for (const auto& retired : retired_vec)
+            destroy_func(retired.second);
+
+        free_vec.clear();
+        retired_vec.clear();
+        capacity = 0u;
+        high_water_mark = 0u;
+    }
+};
+
+// Command pools are externally synchronized, so every recording thread gets its own.
+struct ThreadCommandPool
+{
+    VkCommandPool vk_handle_cmd_pool;
+    RecyclingPool<VkCommandBuffer> cmd_buff_pool;
+};
+
+static RecyclingPool<VkFence> fence_pool;
+static RecyclingPool<VkSemaphore> sem4_pool;
+
+// Pooled binary semaphores that were handed out and not waited on by a submit or present yet. One released
+// from here may still have a pending signal (e.g. an acquire abandoned after VK_ERROR_OUT_OF_DATE_KHR), it
+// is parked until drop_unwaited_pooled_semaphores instead of being signaled a second time.
+static std::mutex sem4_wait_mutex;
+static std::unordered_set<VkSemaphore> unwaited_sem4_set;
+static std::vector<VkSemaphore> dropped_sem4_vec;
+
+static void mark_semaphores_waited(uint32_t sem4_count, const VkSemaphore* p_sem4s)
+{
+    std::lock_guard<std::mutex> sem4_wait_lock(sem4_wait_mutex);
+
+    for (uint32_t i = 0; i < sem4_count; i++)
+        unwaited_sem4_set.erase(p_sem4s[i]);
+}
+
+static void mark_semaphores_waited(uint32_t sem4_count, const VkSemaphoreSubmitInfo* p_sem4_infos)
+{
+    std::lock_guard<std::mutex> sem4_wait_lock(sem4_wait_mutex);
+
+    for (uint32_t i = 0; i < sem4_count; i++)
+        unwaited_sem4_set.erase(p_sem4_infos[i].semaphore);
+}
+
+static std::mutex thread_cmd_pool_mutex;
+static std::vector<std::unique_ptr<ThreadCommandPool>> thread_cmd_pool_vec;
+static std::unordered_map<VkCommandBuffer, ThreadCommandPool*> pooled_cmd_buff_owner_map;
+// terminate can't reach the thread_local pointers of other threads, they are stale once the generation changed.
+static std::atomic<uint32_t> thread_cmd_pool_generation {0u};
+static thread_local ThreadCommandPool* tls_thread_cmd_pool = nullptr;
+static thread_local uint32_t tls_thread_cmd_pool_generation = 0u;
+
+static std::mutex deferred_destruction_mutex;
+static std::vector<std::pair<uint64_t, std::function<void()>>> deferred_destruction_vec;
 
 
 VkQueryPool create_query_pool(VkQueryType type, uint32_t count, VkQueryPipelineStatisticFlags pipeline_stat_flags, VkQueryPoolCreateFlags query_pool_flags, void* p_next)
@@ -455,13 +649,192 @@ bool extension_requested(const std::vector<const char*>& extension_vec, const ch
     return (it != extension_vec.end());
 }
 
+// Data saved by a different driver or device is dropped, drivers are not required to reject it themselves.
+static std::vector<char> load_pipeline_cache_data(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+
+    if (!file.is_open())
+        return {};
+
+    std::vector<char> data(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(data.data(), data.size());
+
+    VkPipelineCacheHeaderVersionOne header;
+
+    if (data.size() < sizeof(header))
+        return {};
+
+    memcpy(&header, data.data(), sizeof(header));
+
+    if (header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+        header.vendorID != vk_phys_dev_props.vendorID ||
+        header.deviceID != vk_phys_dev_props.deviceID ||
+        memcmp(header.pipelineCacheUUID, vk_phys_dev_props.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+    {
+        LOG("Pipeline cache %s was saved by a different driver, starting empty\n", path.c_str());
+        return {};
+    }
+
+    return data;
+}
+
+static void save_pipeline_cache_data(const std::string& path)
+{
+    size_t size = 0u;
+    VK_CHECK(vkGetPipelineCacheData(vk_handle_device, vk_handle_pipeline_cache, &size, nullptr));
+
+    std::vector<char> data(size);
+    VK_CHECK(vkGetPipelineCacheData(vk_handle_device, vk_handle_pipeline_cache, &size, data.data()));
+
+    // Written next to the target and renamed over it, a crash while saving keeps the previous cache.
+    const std::string tmp_path = path + ".tmp";
+
+    {
+        std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+        file.write(data.data(), size);
+
+        if (!file.good())
+        {
+            LOG("Failed to write pipeline cache %s\n", tmp_path.c_str());
+            return;
+        }
+    }
+
+    if (rename(tmp_path.c_str(), path.c_str()) != 0)
+        LOG("Failed to replace pipeline cache %s\n", path.c_str());
+}
+
 void init(const InitInfo& init_info)
 {
     vk_handle_instance = create_instance(init_info.api_version, init_info.instance_layers, init_info.instance_extensions);
     vk_handle_surface = create_surface(vk_handle_instance, init_info.glfw_window);
     vk_handle_physical_device = select_physical_device(vk_handle_instance, init_info.physical_device_ID);
     queue_family_idx = select_queue_family_index(vk_handle_physical_device, vk_handle_surface, init_info.queue_flags, init_info.queue_needs_present);
-    vk_handle_device = create_device(vk_handle_physical_device, queue_family_idx, init_info.device_pnext_chain, init_info.device_layers, init_info.device_extensions);
+
+    std::vector<const char*> device_extension_vec = init_info.device_extensions;
+    void* device_pnext_chain = init_info.device_pnext_chain;
+
+    for (const char* extension_name : init_info.optional_device_extensions)
+    {
+        if (device_extension_supported(vk_handle_physical_device, extension_name))
+            device_extension_vec.push_back(extension_name);
+        else
+            LOG("Optional device extension %s is not supported\n", extension_name);
+    }
+
+    // Optional extensions that come with a feature are only kept if the feature is supported, vk_core
+    // enables the feature itself so the application does not chain structs for disabled extensions.
+    VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT graphics_pipeline_library_features {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT,
+        .pNext = nullptr,
+        .graphicsPipelineLibrary = VK_FALSE,
+    };
+
+    if (extension_requested(init_info.optional_device_extensions, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME) &&
+        extension_requested(device_extension_vec, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME))
+    {
+        VkPhysicalDeviceFeatures2 features {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+            .pNext = &graphics_pipeline_library_features,
+        };
+
+        vkGetPhysicalDeviceFeatures2(vk_handle_physical_device, &features);
+
+        if (graphics_pipeline_library_features.graphicsPipelineLibrary == VK_TRUE &&
+            extension_requested(device_extension_vec, VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME))
+        {
+            graphics_pipeline_library_features.pNext = device_pnext_chain;
+            device_pnext_chain = &graphics_pipeline_library_features;
+        }
+        else
+        {
+            std::erase_if(device_extension_vec, [](const char* extension_name) { return strcmp(extension_name, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME) == 0; });
+            LOG("Optional device extension %s is not usable\n", VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+        }
+    }
+
+    // Only the color blend subset of extended dynamic state 3 is used.
+    VkPhysicalDeviceExtendedDynamicState3FeaturesEXT extended_dynamic_state_3_features {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT,
+        .pNext = nullptr,
+    };
+
+    if (extension_requested(init_info.optional_device_extensions, VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME) &&
+        extension_requested(device_extension_vec, VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME))
+    {
+        VkPhysicalDeviceFeatures2 features {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+            .pNext = &extended_dynamic_state_3_features,
+        };
+
+        vkGetPhysicalDeviceFeatures2(vk_handle_physical_device, &features);
+
+        if (extended_dynamic_state_3_features.extendedDynamicState3ColorBlendEnable == VK_TRUE &&
+            extended_dynamic_state_3_features.extendedDynamicState3ColorBlendEquation == VK_TRUE &&
+            extended_dynamic_state_3_features.extendedDynamicState3ColorWriteMask == VK_TRUE)
+        {
+            extended_dynamic_state_3_features = {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT,
+                .pNext = device_pnext_chain,
+                .extendedDynamicState3ColorBlendEnable = VK_TRUE,
+                .extendedDynamicState3ColorBlendEquation = VK_TRUE,
+                .extendedDynamicState3ColorWriteMask = VK_TRUE,
+            };
+
+            device_pnext_chain = &extended_dynamic_state_3_features;
+        }
+        else
+        {
+            std::erase_if(device_extension_vec, [](const char* extension_name) { return strcmp(extension_name, VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME) == 0; });
+            LOG("Optional device extension %s is not usable\n", VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+        }
+    }
+
+    // Descriptor buffer addresses come from vkGetBufferDeviceAddress, the application enables bufferDeviceAddress.
+    // With VK_KHR_push_descriptor enabled as well, descriptor buffers are only used if push descriptors work
+    // with them.
+    VkPhysicalDeviceDescriptorBufferFeaturesEXT descriptor_buffer_features {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT,
+        .pNext = nullptr,
+        .descriptorBuffer = VK_FALSE,
+        .descriptorBufferPushDescriptors = VK_FALSE,
+    };
+
+    if (extension_requested(init_info.optional_device_extensions, VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME) &&
+        extension_requested(device_extension_vec, VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME))
+    {
+        VkPhysicalDeviceFeatures2 features {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+            .pNext = &descriptor_buffer_features,
+        };
+
+        vkGetPhysicalDeviceFeatures2(vk_handle_physical_device, &features);
+
+        const bool push_descriptors = extension_requested(device_extension_vec, VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+
+        if (descriptor_buffer_features.descriptorBuffer == VK_TRUE &&
+            (!push_descriptors || descriptor_buffer_features.descriptorBufferPushDescriptors == VK_TRUE))
+        {
+            descriptor_buffer_features = {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT,
+                .pNext = device_pnext_chain,
+                .descriptorBuffer = VK_TRUE,
+                .descriptorBufferPushDescriptors = push_descriptors ? VK_TRUE : VK_FALSE,
+            };
+
+            device_pnext_chain = &descriptor_buffer_features;
+        }
+        else
+        {
+            std::erase_if(device_extension_vec, [](const char* extension_name) { return strcmp(extension_name, VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME) == 0; });
+            LOG("Optional device extension %s is not usable\n", VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME);
+        }
+    }
+
+    vk_handle_device = create_device(vk_handle_physical_device, queue_family_idx, device_pnext_chain, init_info.device_layers, device_extension_vec);
+    enabled_device_extension_vec.assign(device_extension_vec.begin(), device_extension_vec.end());
     vk_handle_queue = get_queue(vk_handle_device, queue_family_idx);
 
     VkSwapchainCreateInfoKHR swapchain_create_info = populate_swapchain_create_info(vk_handle_physical_device, vk_handle_surface, init_info.swapchain_min_image_count, init_info.swapchain_image_extent, init_info.swapchain_image_format, init_info.swapchain_present_mode);
@@ -469,8 +842,92 @@ void init(const InitInfo& init_info)
     vk_handle_swapchain_image_vec = get_swapchain_images(vk_handle_device, vk_handle_swapchain);
     vk_handle_swapchain_image_view_vec = create_swapchain_image_views(vk_handle_device, vk_handle_swapchain_image_vec, swapchain_create_info.imageFormat);
 
+    VkSurfaceCapabilitiesKHR surface_capabilities;
+    VK_CHECK(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(vk_handle_physical_device, vk_handle_surface, &surface_capabilities));
+    surface_min_image_count = surface_capabilities.minImageCount;
+
     vkGetPhysicalDeviceProperties(vk_handle_physical_device, &vk_phys_dev_props);
 
+    // The application enables the features through init_info.device_pnext_chain, either struct may carry them.
+    vk_enabled_subgroup_size_control_features = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_SIZE_CONTROL_FEATURES,
+        .pNext = nullptr,
+        .subgroupSizeControl = VK_FALSE,
+        .computeFullSubgroups = VK_FALSE,
+    };
+
+    for (const VkBaseInStructure* p_struct = static_cast<const VkBaseInStructure*>(init_info.device_pnext_chain); p_struct != nullptr; p_struct = p_struct->pNext)
+    {
+        if (p_struct->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES)
+        {
+            const auto* p_features_13 = reinterpret_cast<const VkPhysicalDeviceVulkan13Features*>(p_struct);
+            vk_enabled_subgroup_size_control_features.subgroupSizeControl |= p_features_13->subgroupSizeControl;
+            vk_enabled_subgroup_size_control_features.computeFullSubgroups |= p_features_13->computeFullSubgroups;
+        }
+        else if (p_struct->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_SIZE_CONTROL_FEATURES)
+        {
+            const auto* p_features = reinterpret_cast<const VkPhysicalDeviceSubgroupSizeControlFeatures*>(p_struct);
+            vk_enabled_subgroup_size_control_features.subgroupSizeControl |= p_features->subgroupSizeControl;
+            vk_enabled_subgroup_size_control_features.computeFullSubgroups |= p_features->computeFullSubgroups;
+        }
+    }
+
+    // Core in 1.3 (VK_EXT_subgroup_size_control before).
+    vk_phys_dev_subgroup_size_control_props = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_SIZE_CONTROL_PROPERTIES,
+        .pNext = nullptr,
+    };
+
+    // Core in 1.2 (VK_EXT_descriptor_indexing before).
+    vk_phys_dev_desc_indexing_props = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES,
+        .pNext = nullptr,
+    };
+
+    vk_phys_dev_subgroup_size_control_props.pNext = &vk_phys_dev_desc_indexing_props;
+
+    vk_phys_dev_desc_buffer_props = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_PROPERTIES_EXT,
+        .pNext = nullptr,
+    };
+
+    vk_phys_dev_push_desc_props = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PUSH_DESCRIPTOR_PROPERTIES_KHR,
+        .pNext = nullptr,
+    };
+
+    // Extension structs are only chained if the extension is enabled.
+    void** pp_props_next = &vk_phys_dev_desc_indexing_props.pNext;
+
+    if (extension_requested(device_extension_vec, VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME))
+    {
+        *pp_props_next = &vk_phys_dev_desc_buffer_props;
+        pp_props_next = &vk_phys_dev_desc_buffer_props.pNext;
+    }
+
+    if (extension_requested(device_extension_vec, VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME))
+        *pp_props_next = &vk_phys_dev_push_desc_props;
+
+    VkPhysicalDeviceProperties2 properties {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+        .pNext = &vk_phys_dev_subgroup_size_control_props,
+    };
+
+    vkGetPhysicalDeviceProperties2(vk_handle_physical_device, &properties);
+
+    pipeline_cache_path = (init_info.pipeline_cache_path != nullptr) ? init_info.pipeline_cache_path : "";
+    const std::vector<char> pipeline_cache_data = pipeline_cache_path.empty() ? std::vector<char>{} : load_pipeline_cache_data(pipeline_cache_path);
+
+    const VkPipelineCacheCreateInfo pipeline_cache_create_info {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0x0,
+        .initialDataSize = pipeline_cache_data.size(),
+        .pInitialData = pipeline_cache_data.data(),
+    };
+
+    VK_CHECK(vkCreatePipelineCache(vk_handle_device, &pipeline_cache_create_info, nullptr, &vk_handle_pipeline_cache));
+
     // Also need to check if correct features are enabled!!!
 
     if (extension_requested(init_info.instance_extensions, VK_EXT_DEBUG_UTILS_EXTENSION_NAME))
@@ -495,10 +952,74 @@ void init(const InitInfo& init_info)
     {
         load_device_function<PFN_vkGetCalibratedTimestampsKHR>(vkGetCalibratedTimestampsKHR, "vkGetCalibratedTimestampsKHR");
     }
+
+    if (extension_requested(device_extension_vec, VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME))
+    {
+        load_device_function<PFN_vkCmdSetColorBlendEnableEXT>(vkCmdSetColorBlendEnableEXT, "vkCmdSetColorBlendEnableEXT");
+        load_device_function<PFN_vkCmdSetColorBlendEquationEXT>(vkCmdSetColorBlendEquationEXT, "vkCmdSetColorBlendEquationEXT");
+        load_device_function<PFN_vkCmdSetColorWriteMaskEXT>(vkCmdSetColorWriteMaskEXT, "vkCmdSetColorWriteMaskEXT");
+    }
+
+    if (extension_requested(device_extension_vec, VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME))
+    {
+        load_device_function<PFN_vkGetDescriptorSetLayoutSizeEXT>(vkGetDescriptorSetLayoutSizeEXT, "vkGetDescriptorSetLayoutSizeEXT");
+        load_device_function<PFN_vkGetDescriptorSetLayoutBindingOffsetEXT>(vkGetDescriptorSetLayoutBindingOffsetEXT, "vkGetDescriptorSetLayoutBindingOffsetEXT");
+        load_device_function<PFN_vkGetDescriptorEXT>(vkGetDescriptorEXT, "vkGetDescriptorEXT");
+        load_device_function<PFN_vkCmdBindDescriptorBuffersEXT>(vkCmdBindDescriptorBuffersEXT, "vkCmdBindDescriptorBuffersEXT");
+        load_device_function<PFN_vkCmdSetDescriptorBufferOffsetsEXT>(vkCmdSetDescriptorBufferOffsetsEXT, "vkCmdSetDescriptorBufferOffsetsEXT");
+    }
+
+    if (extension_requested(device_extension_vec, VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME))
+    {
+        load_device_function<PFN_vkCmdPushDescriptorSetKHR>(vkCmdPushDescriptorSetKHR, "vkCmdPushDescriptorSetKHR");
+    }
+
+    // Requires the timelineSemaphore (1.2) and synchronization2 (1.3) features to be enabled.
+    vk_handle_submit_timeline_sem4 = create_timeline_semaphore(0u);
+    submit_timeline_value = 0u;
 }
 
 void terminate()
 {
+    ASSERT(submit_batch_vec.empty(), "Warning - Terminating with %lu unflushed submits!\n", submit_batch_vec.size());
+
+    // The application is expected to have waited for the queue to be idle.
+    for (const auto& deferred : std::exchange(deferred_destruction_vec, {}))
+        deferred.second();
+
+    fence_pool.clear([](VkFence vk_handle_fence) { vkDestroyFence(vk_handle_device, vk_handle_fence, nullptr); });
+    sem4_pool.clear([](VkSemaphore vk_handle_sem4) { vkDestroySemaphore(vk_handle_device, vk_handle_sem4, nullptr); });
+
+    {
+        std::lock_guard<std::mutex> sem4_wait_lock(sem4_wait_mutex);
+
+        for (const VkSemaphore vk_handle_sem4 : dropped_sem4_vec)
+            vkDestroySemaphore(vk_handle_device, vk_handle_sem4, nullptr);
+
+        dropped_sem4_vec.clear();
+        unwaited_sem4_set.clear();
+    }
+
+    {
+        // Destroying the command pool frees its command buffers.
+        std::lock_guard<std::mutex> thread_cmd_pool_lock(thread_cmd_pool_mutex);
+
+        for (const auto& thread_cmd_pool : thread_cmd_pool_vec)
+            vkDestroyCommandPool(vk_handle_device, thread_cmd_pool->vk_handle_cmd_pool, nullptr);
+
+        thread_cmd_pool_vec.clear();
+        pooled_cmd_buff_owner_map.clear();
+        thread_cmd_pool_generation++;
+        tls_thread_cmd_pool = nullptr;
+    }
+
+    vkDestroySemaphore(vk_handle_device, vk_handle_submit_timeline_sem4, nullptr);
+
+    if (!pipeline_cache_path.empty())
+        save_pipeline_cache_data(pipeline_cache_path);
+
+    vkDestroyPipelineCache(vk_handle_device, vk_handle_pipeline_cache, nullptr);
+
     for (uint32_t i = 0; i < vk_handle_swapchain_image_vec.size(); i++)
     {
         vkDestroyImageView(vk_handle_device, vk_handle_swapchain_image_view_vec[i], nullptr);
@@ -506,11 +1027,17 @@ void terminate()
 
     vkDestroySwapchainKHR(vk_handle_device, vk_handle_swapchain, nullptr);
     vkDestroyDevice(vk_handle_device, nullptr);
+    enabled_device_extension_vec.clear();
     vkDestroySurfaceKHR(vk_handle_instance, vk_handle_surface, nullptr);
     vkDestroyInstance(vk_handle_instance, nullptr);
 }
 
 
+bool is_device_extension_enabled(const char* extension_name)
+{
+    return std::find(enabled_device_extension_vec.begin(), enabled_device_extension_vec.end(), extension_name) != enabled_device_extension_vec.end();
+}
+
 VkInstance get_instance() { return vk_handle_instance; }
 VkPhysicalDevice get_physical_device() { return vk_handle_physical_device; }
 VkDevice get_device() { return vk_handle_device; }
@@ -521,6 +1048,12 @@ int32_t get_swapchain_image_count()
     return static_cast<int32_t>(vk_handle_swapchain_image_vec.size());
 }
 
+uint32_t get_max_acquired_swapchain_image_count()
+{
+    // vkAcquireNextImageKHR may only wait forever while at most imageCount - minImageCount images are acquired.
+    return static_cast<uint32_t>(vk_handle_swapchain_image_vec.size()) - surface_min_image_count + 1u;
+}
+
 VkImage get_swapchain_image(int32_t idx)
 {
     assert(idx < vk_handle_swapchain_image_vec.size());
@@ -534,6 +1067,31 @@ const VkPhysicalDeviceProperties& get_physical_device_properties()
     return vk_phys_dev_props;
 }
 
+const VkPhysicalDeviceSubgroupSizeControlProperties& get_physical_device_subgroup_size_control_properties()
+{
+    return vk_phys_dev_subgroup_size_control_props;
+}
+
+const VkPhysicalDeviceSubgroupSizeControlFeatures& get_enabled_subgroup_size_control_features()
+{
+    return vk_enabled_subgroup_size_control_features;
+}
+
+const VkPhysicalDeviceDescriptorIndexingProperties& get_physical_device_descriptor_indexing_properties()
+{
+    return vk_phys_dev_desc_indexing_props;
+}
+
+const VkPhysicalDeviceDescriptorBufferPropertiesEXT& get_physical_device_descriptor_buffer_properties()
+{
+    return vk_phys_dev_desc_buffer_props;
+}
+
+const VkPhysicalDevicePushDescriptorPropertiesKHR& get_physical_device_push_descriptor_properties()
+{
+    return vk_phys_dev_push_desc_props;
+}
+
 void present(uint32_t swapchain_image_idx, std::vector<VkSemaphore>&& vk_handle_wait_sem4_vec, void* p_next)
 {
     const VkPresentInfoKHR present_info {
@@ -547,7 +1105,9 @@ void present(uint32_t swapchain_image_idx, std::vector<VkSemaphore>&& vk_handle_
         .pResults = nullptr,
     };
 
+    std::lock_guard<std::mutex> queue_lock(queue_mutex);
     VK_CHECK(vkQueuePresentKHR(vk_handle_queue, &present_info));
+    mark_semaphores_waited(present_info.waitSemaphoreCount, present_info.pWaitSemaphores);
 }
 
 void wait_for_present(uint64_t present_id, uint64_t timeout)
@@ -557,61 +1117,436 @@ void wait_for_present(uint64_t present_id, uint64_t timeout)
 
 void device_wait_idle()
 {
+    std::lock_guard<std::mutex> queue_lock(queue_mutex);
     VK_CHECK(vkDeviceWaitIdle(vk_handle_device));
 }
 
 void queue_submit(const VkSubmitInfo& submit_info, VkFence vk_handle_signal_fence)
 {
-    VK_CHECK(vkQueueSubmit(vk_handle_queue, 1u, &submit_info, vk_handle_signal_fence));
+    queue_submit(1u, &submit_info, vk_handle_signal_fence);
 }
 
-void queue_wait_idle()
+void queue_submit(const uint32_t submit_count, const VkSubmitInfo* const p_submit_infos, const VkFence vk_handle_signal_fence)
 {
-    VK_CHECK(vkQueueWaitIdle(vk_handle_queue));
-}
+    std::lock_guard<std::mutex> queue_lock(queue_mutex);
+    VK_CHECK(vkQueueSubmit(vk_handle_queue, submit_count, p_submit_infos, vk_handle_signal_fence));
 
+    for (uint32_t i = 0; i < submit_count; i++)
+        mark_semaphores_waited(p_submit_infos[i].waitSemaphoreCount, p_submit_infos[i].pWaitSemaphores);
+}
 
-VkSemaphore create_semaphore(VkSemaphoreCreateFlags flags)
+void queue_submit2(const uint32_t submit_count, const VkSubmitInfo2* const p_submit_infos, const VkFence vk_handle_signal_fence)
 {
-    const VkSemaphoreCreateInfo create_info {
-        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
-        .pNext = nullptr,
-        .flags = 0x0,
-    };
+    std::lock_guard<std::mutex> queue_lock(queue_mutex);
+    VK_CHECK(vkQueueSubmit2(vk_handle_queue, submit_count, p_submit_infos, vk_handle_signal_fence));
 
-    VkSemaphore vk_handle_sem4 = VK_NULL_HANDLE;
-    VK_CHECK(vkCreateSemaphore(vk_handle_device, &create_info, nullptr, &vk_handle_sem4));
-    return vk_handle_sem4;
+    for (uint32_t i = 0; i < submit_count; i++)
+        mark_semaphores_waited(p_submit_infos[i].waitSemaphoreInfoCount, p_submit_infos[i].pWaitSemaphoreInfos);
 }
 
-void destroy_semaphore(VkSemaphore vk_handle_sem4)
+void queue_wait_idle()
 {
-    vkDestroySemaphore(vk_handle_device, vk_handle_sem4, nullptr);
+    std::lock_guard<std::mutex> queue_lock(queue_mutex);
+    VK_CHECK(vkQueueWaitIdle(vk_handle_queue));
 }
 
-VkFence create_fence(VkFenceCreateFlags flags)
+VkSemaphoreSubmitInfo semaphore_submit_info(VkSemaphore vk_handle_sem4, VkPipelineStageFlags2 stage_mask, uint64_t value)
 {
-    const VkFenceCreateInfo create_info {
-        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+    const VkSemaphoreSubmitInfo submit_info {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
         .pNext = nullptr,
-        .flags = flags,
+        .semaphore = vk_handle_sem4,
+        .value = value,
+        .stageMask = stage_mask,
+        .deviceIndex = 0u,
     };
 
-    VkFence vk_handle_fence = VK_NULL_HANDLE;
-    VK_CHECK(vkCreateFence(vk_handle_device, &create_info, nullptr, &vk_handle_fence));
-    return vk_handle_fence;
+    return submit_info;
 }
 
-VkFence create_fence(const char* name, VkFenceCreateFlags flags)
+// Appends a signal of the next submit timeline value to the last submit and hands the whole list to
+// the driver in one call. The value is assigned under the queue lock so it increases in submission order.
+static uint64_t submit_batch_with_timeline_signal(std::vector<BatchedSubmit>& batch_vec, VkFence vk_handle_signal_fence)
 {
-    const VkFence vk_handle_fence = create_fence(flags);
+    if (batch_vec.empty())
+        batch_vec.push_back({});
 
-    const VkDebugUtilsObjectNameInfoEXT debug_info {
-        .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
-        .pNext = nullptr,
-        .objectType = VK_OBJECT_TYPE_FENCE,
-        .objectHandle = reinterpret_cast<uint64_t>(vk_handle_fence),
-        .pObjectName = name,
+    std::vector<VkSubmitInfo2> submit_info_vec;
+    submit_info_vec.reserve(batch_vec.size());
+
+    std::lock_guard<std::mutex> queue_lock(queue_mutex);
+
+    const uint64_t signal_value = ++submit_timeline_value;
+    batch_vec.back().signal_sem4_vec.push_back(semaphore_submit_info(vk_handle_submit_timeline_sem4, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, signal_value));
+
+    for (const BatchedSubmit& batched_submit : batch_vec)
+    {
+        const VkSubmitInfo2 submit_info {
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+            .pNext = batched_submit.p_next,
+            .flags = 0x0,
+            .waitSemaphoreInfoCount = static_cast<uint32_t>(batched_submit.wait_sem4_vec.size()),
+            .pWaitSemaphoreInfos = batched_submit.wait_sem4_vec.data(),
+            .commandBufferInfoCount = static_cast<uint32_t>(batched_submit.cmd_buff_vec.size()),
+            .pCommandBufferInfos = batched_submit.cmd_buff_vec.data(),
+            .signalSemaphoreInfoCount = static_cast<uint32_t>(batched_submit.signal_sem4_vec.size()),
+            .pSignalSemaphoreInfos = batched_submit.signal_sem4_vec.data(),
+        };
+
+        submit_info_vec.push_back(submit_info);
+    }
+
+    VK_CHECK(vkQueueSubmit2(vk_handle_queue, static_cast<uint32_t>(submit_info_vec.size()), submit_info_vec.data(), vk_handle_signal_fence));
+
+    for (const VkSubmitInfo2& submit_info : submit_info_vec)
+        mark_semaphores_waited(submit_info.waitSemaphoreInfoCount, submit_info.pWaitSemaphoreInfos);
+
+    return signal_value;
+}
+
+void enqueue_submit(std::vector<VkCommandBuffer>&& vk_handle_cmd_buff_vec, std::vector<VkSemaphoreSubmitInfo>&& wait_sem4_vec, std::vector<VkSemaphoreSubmitInfo>&& signal_sem4_vec, const void* p_next)
+{
+    BatchedSubmit batched_submit {
+        .wait_sem4_vec = std::move(wait_sem4_vec),
+        .cmd_buff_vec = {},
+        .signal_sem4_vec = std::move(signal_sem4_vec),
+        .p_next = p_next,
+    };
+
+    batched_submit.cmd_buff_vec.reserve(vk_handle_cmd_buff_vec.size());
+
+    for (const VkCommandBuffer vk_handle_cmd_buff : vk_handle_cmd_buff_vec)
+    {
+        const VkCommandBufferSubmitInfo cmd_buff_submit_info {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+            .pNext = nullptr,
+            .commandBuffer = vk_handle_cmd_buff,
+            .deviceMask = 0x0,
+        };
+
+        batched_submit.cmd_buff_vec.push_back(cmd_buff_submit_info);
+    }
+
+    std::lock_guard<std::mutex> batch_lock(submit_batch_mutex);
+    submit_batch_vec.push_back(std::move(batched_submit));
+}
+
+uint64_t flush_submit_batch(VkFence vk_handle_signal_fence)
+{
+    std::lock_guard<std::mutex> batch_lock(submit_batch_mutex);
+
+    if (submit_batch_vec.empty() && vk_handle_signal_fence == VK_NULL_HANDLE)
+        return get_submit_timeline_value();
+
+    const uint64_t signal_value = submit_batch_with_timeline_signal(submit_batch_vec, vk_handle_signal_fence);
+    submit_batch_vec.clear();
+    return signal_value;
+}
+
+VkSemaphore create_timeline_semaphore(uint64_t initial_value)
+{
+    const VkSemaphoreTypeCreateInfo type_create_info {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+        .pNext = nullptr,
+        .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+        .initialValue = initial_value,
+    };
+
+    const VkSemaphoreCreateInfo create_info {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = &type_create_info,
+        .flags = 0x0,
+    };
+
+    VkSemaphore vk_handle_sem4 = VK_NULL_HANDLE;
+    VK_CHECK(vkCreateSemaphore(vk_handle_device, &create_info, nullptr, &vk_handle_sem4));
+    return vk_handle_sem4;
+}
+
+uint64_t get_submit_timeline_value()
+{
+    std::lock_guard<std::mutex> queue_lock(queue_mutex);
+    return submit_timeline_value;
+}
+
+uint64_t get_completed_timeline_value()
+{
+    uint64_t value = 0u;
+    VK_CHECK(vkGetSemaphoreCounterValue(vk_handle_device, vk_handle_submit_timeline_sem4, &value));
+    return value;
+}
+
+bool wait_for_timeline_value(uint64_t value, uint64_t timeout)
+{
+    const VkSemaphoreWaitInfo wait_info {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+        .pNext = nullptr,
+        .flags = 0x0,
+        .semaphoreCount = 1u,
+        .pSemaphores = &vk_handle_submit_timeline_sem4,
+        .pValues = &value,
+    };
+
+    // A finite timeout may expire, that is not an error.
+    const VkResult result = vkWaitSemaphores(vk_handle_device, &wait_info, timeout);
+
+    if (result == VK_TIMEOUT)
+        return false;
+
+    VK_CHECK(result);
+    return true;
+}
+
+bool is_timeline_value_complete(uint64_t value)
+{
+    return get_completed_timeline_value() >= value;
+}
+
+uint64_t immediate_submit(const std::function<void(VkCommandBuffer)>& record_func)
+{
+    const VkCommandBuffer vk_handle_cmd_buff = acquire_pooled_command_buffer();
+
+    begin_command_buffer(vk_handle_cmd_buff, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+    record_func(vk_handle_cmd_buff);
+    end_command_buffer(vk_handle_cmd_buff);
+
+    const VkCommandBufferSubmitInfo cmd_buff_submit_info {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+        .pNext = nullptr,
+        .commandBuffer = vk_handle_cmd_buff,
+        .deviceMask = 0x0,
+    };
+
+    std::vector<BatchedSubmit> batch_vec {{
+        .wait_sem4_vec = {},
+        .cmd_buff_vec = {cmd_buff_submit_info},
+        .signal_sem4_vec = {},
+        .p_next = nullptr,
+    }};
+
+    const uint64_t timeline_value = submit_batch_with_timeline_signal(batch_vec, VK_NULL_HANDLE);
+    release_pooled_command_buffer(vk_handle_cmd_buff, timeline_value);
+    return timeline_value;
+}
+
+static ThreadCommandPool& get_thread_command_pool()
+{
+    if (tls_thread_cmd_pool == nullptr || tls_thread_cmd_pool_generation != thread_cmd_pool_generation)
+    {
+        auto thread_cmd_pool = std::make_unique<ThreadCommandPool>();
+        thread_cmd_pool->vk_handle_cmd_pool = create_command_pool(VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+        tls_thread_cmd_pool = thread_cmd_pool.get();
+        tls_thread_cmd_pool_generation = thread_cmd_pool_generation;
+
+        std::lock_guard<std::mutex> thread_cmd_pool_lock(thread_cmd_pool_mutex);
+        thread_cmd_pool_vec.push_back(std::move(thread_cmd_pool));
+    }
+
+    return *tls_thread_cmd_pool;
+}
+
+static VkCommandBuffer create_pooled_command_buffer(ThreadCommandPool& thread_cmd_pool)
+{
+    const VkCommandBuffer vk_handle_cmd_buff = allocate_command_buffer("Pooled - CommandBuffer", thread_cmd_pool.vk_handle_cmd_pool, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+
+    std::lock_guard<std::mutex> thread_cmd_pool_lock(thread_cmd_pool_mutex);
+    pooled_cmd_buff_owner_map[vk_handle_cmd_buff] = &thread_cmd_pool;
+    return vk_handle_cmd_buff;
+}
+
+void reserve_pools(uint32_t fence_count, uint32_t sem4_count, uint32_t cmd_buff_count)
+{
+    fence_pool.reserve(fence_count, []() { return create_fence(); });
+    sem4_pool.reserve(sem4_count, []() { return create_semaphore(); });
+
+    ThreadCommandPool& thread_cmd_pool = get_thread_command_pool();
+    thread_cmd_pool.cmd_buff_pool.reserve(cmd_buff_count, [&thread_cmd_pool]() { return create_pooled_command_buffer(thread_cmd_pool); });
+}
+
+VkFence acquire_pooled_fence()
+{
+    return fence_pool.acquire(get_completed_timeline_value(), 
+        []() { return create_fence(); },
+        [](VkFence vk_handle_fence) {
+            if (vkGetFenceStatus(vk_handle_device, vk_handle_fence) != VK_SUCCESS)
+                return false;
+
+            reset_fence(vk_handle_fence);
+            return true;
+        });
+}
+
+VkSemaphore acquire_pooled_semaphore()
+{
+    // Only semaphores whose wait was submitted are released to the pool, their signal has been consumed.
+    const VkSemaphore vk_handle_sem4 = sem4_pool.acquire(get_completed_timeline_value(), 
+        []() { return create_semaphore(); },
+        [](VkSemaphore) { return true; });
+
+    std::lock_guard<std::mutex> sem4_wait_lock(sem4_wait_mutex);
+    unwaited_sem4_set.insert(vk_handle_sem4);
+    return vk_handle_sem4;
+}
+
+VkCommandBuffer acquire_pooled_command_buffer()
+{
+    ThreadCommandPool& thread_cmd_pool = get_thread_command_pool();
+
+    return thread_cmd_pool.cmd_buff_pool.acquire(get_completed_timeline_value(), 
+        [&thread_cmd_pool]() { return create_pooled_command_buffer(thread_cmd_pool); },
+        [](VkCommandBuffer vk_handle_cmd_buff) {
+            VK_CHECK(vkResetCommandBuffer(vk_handle_cmd_buff, 0x0));
+            return true;
+        });
+}
+
+void release_pooled_fence(VkFence vk_handle_fence, uint64_t timeline_value)
+{
+    fence_pool.release(vk_handle_fence, timeline_value);
+}
+
+void release_pooled_semaphore(VkSemaphore vk_handle_sem4, uint64_t timeline_value)
+{
+    {
+        std::lock_guard<std::mutex> sem4_wait_lock(sem4_wait_mutex);
+
+        if (unwaited_sem4_set.erase(vk_handle_sem4) > 0u)
+        {
+            dropped_sem4_vec.push_back(vk_handle_sem4);
+            return;
+        }
+    }
+
+    sem4_pool.release(vk_handle_sem4, timeline_value);
+}
+
+void drop_unwaited_pooled_semaphores()
+{
+    std::lock_guard<std::mutex> sem4_wait_lock(sem4_wait_mutex);
+
+    for (const VkSemaphore vk_handle_sem4 : dropped_sem4_vec)
+        vkDestroySemaphore(vk_handle_device, vk_handle_sem4, nullptr);
+
+    sem4_pool.forget(static_cast<uint32_t>(dropped_sem4_vec.size()));
+    dropped_sem4_vec.clear();
+}
+
+void release_pooled_command_buffer(VkCommandBuffer vk_handle_cmd_buff, uint64_t timeline_value)
+{
+    ThreadCommandPool* owner = nullptr;
+
+    {
+        std::lock_guard<std::mutex> thread_cmd_pool_lock(thread_cmd_pool_mutex);
+        owner = pooled_cmd_buff_owner_map.at(vk_handle_cmd_buff);
+    }
+
+    owner->cmd_buff_pool.release(vk_handle_cmd_buff, timeline_value);
+}
+
+PoolStats get_fence_pool_stats()
+{
+    return fence_pool.get_stats();
+}
+
+PoolStats get_semaphore_pool_stats()
+{
+    return sem4_pool.get_stats();
+}
+
+PoolStats get_command_buffer_pool_stats()
+{
+    PoolStats total_stats {};
+    std::vector<ThreadCommandPool*> thread_cmd_pool_ptr_vec;
+
+    // Pool locks are taken before the registry lock on acquire, so don't hold both here.
+    {
+        std::lock_guard<std::mutex> thread_cmd_pool_lock(thread_cmd_pool_mutex);
+
+        for (const auto& thread_cmd_pool : thread_cmd_pool_vec)
+            thread_cmd_pool_ptr_vec.push_back(thread_cmd_pool.get());
+    }
+
+    for (ThreadCommandPool* thread_cmd_pool : thread_cmd_pool_ptr_vec)
+    {
+        const PoolStats stats = thread_cmd_pool->cmd_buff_pool.get_stats();
+        total_stats.capacity += stats.capacity;
+        total_stats.in_use += stats.in_use;
+        total_stats.high_water_mark += stats.high_water_mark;
+    }
+
+    return total_stats;
+}
+
+void defer_destruction(uint64_t timeline_value, std::function<void()>&& destroy_func)
+{
+    std::lock_guard<std::mutex> deferred_destruction_lock(deferred_destruction_mutex);
+    deferred_destruction_vec.push_back({timeline_value, std::move(destroy_func)});
+}
+
+void run_deferred_destructions()
+{
+    const uint64_t completed_value = get_completed_timeline_value();
+    std::vector<std::function<void()>> destroy_func_vec;
+
+    // Run outside the lock, destroy functions may defer more destructions.
+    {
+        std::lock_guard<std::mutex> deferred_destruction_lock(deferred_destruction_mutex);
+
+        std::erase_if(deferred_destruction_vec, [&](std::pair<uint64_t, std::function<void()>>& deferred) {
+            if (deferred.first > completed_value)
+                return false;
+
+            destroy_func_vec.push_back(std::move(deferred.second));
+            return true;
+        });
+    }
+
+    for (const auto& destroy_func : destroy_func_vec)
+        destroy_func();
+}
+
+
+VkSemaphore create_semaphore(VkSemaphoreCreateFlags flags)
+{
+    const VkSemaphoreCreateInfo create_info {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0x0,
+    };
+
+    VkSemaphore vk_handle_sem4 = VK_NULL_HANDLE;
+    VK_CHECK(vkCreateSemaphore(vk_handle_device, &create_info, nullptr, &vk_handle_sem4));
+    return vk_handle_sem4;
+}
+
+void destroy_semaphore(VkSemaphore vk_handle_sem4)
+{
+    vkDestroySemaphore(vk_handle_device, vk_handle_sem4, nullptr);
+}
+
+VkFence create_fence(VkFenceCreateFlags flags)
+{
+    const VkFenceCreateInfo create_info {
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = flags,
+    };
+
+    VkFence vk_handle_fence = VK_NULL_HANDLE;
+    VK_CHECK(vkCreateFence(vk_handle_device, &create_info, nullptr, &vk_handle_fence));
+    return vk_handle_fence;
+}
+
+VkFence create_fence(const char* name, VkFenceCreateFlags flags)
+{
+    const VkFence vk_handle_fence = create_fence(flags);
+
+    const VkDebugUtilsObjectNameInfoEXT debug_info {
+        .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
+        .pNext = nullptr,
+        .objectType = VK_OBJECT_TYPE_FENCE,
+        .objectHandle = reinterpret_cast<uint64_t>(vk_handle_fence),
+        .pObjectName = name,
     };
 
     if (vkSetDebugUtilsObjectNameEXT)
@@ -766,6 +1701,104 @@ void debug_utils_end_label(VkCommandBuffer vk_handle_cmd_buff)
     vkCmdEndDebugUtilsLabelEXT(vk_handle_cmd_buff);
 }
 
+void cmd_set_viewport(VkCommandBuffer vk_handle_cmd_buff, uint32_t first_viewport, const std::vector<VkViewport>& viewport_vec)
+{
+    vkCmdSetViewport(vk_handle_cmd_buff, first_viewport, static_cast<uint32_t>(viewport_vec.size()), viewport_vec.data());
+}
+
+void cmd_set_scissor(VkCommandBuffer vk_handle_cmd_buff, uint32_t first_scissor, const std::vector<VkRect2D>& scissor_vec)
+{
+    vkCmdSetScissor(vk_handle_cmd_buff, first_scissor, static_cast<uint32_t>(scissor_vec.size()), scissor_vec.data());
+}
+
+void cmd_set_viewport_with_count(VkCommandBuffer vk_handle_cmd_buff, const std::vector<VkViewport>& viewport_vec)
+{
+    vkCmdSetViewportWithCount(vk_handle_cmd_buff, static_cast<uint32_t>(viewport_vec.size()), viewport_vec.data());
+}
+
+void cmd_set_scissor_with_count(VkCommandBuffer vk_handle_cmd_buff, const std::vector<VkRect2D>& scissor_vec)
+{
+    vkCmdSetScissorWithCount(vk_handle_cmd_buff, static_cast<uint32_t>(scissor_vec.size()), scissor_vec.data());
+}
+
+void cmd_set_cull_mode(VkCommandBuffer vk_handle_cmd_buff, VkCullModeFlags cull_mode)
+{
+    vkCmdSetCullMode(vk_handle_cmd_buff, cull_mode);
+}
+
+void cmd_set_front_face(VkCommandBuffer vk_handle_cmd_buff, VkFrontFace front_face)
+{
+    vkCmdSetFrontFace(vk_handle_cmd_buff, front_face);
+}
+
+void cmd_set_depth_test_enable(VkCommandBuffer vk_handle_cmd_buff, VkBool32 test_enable)
+{
+    vkCmdSetDepthTestEnable(vk_handle_cmd_buff, test_enable);
+}
+
+void cmd_set_depth_write_enable(VkCommandBuffer vk_handle_cmd_buff, VkBool32 write_enable)
+{
+    vkCmdSetDepthWriteEnable(vk_handle_cmd_buff, write_enable);
+}
+
+void cmd_set_depth_compare_op(VkCommandBuffer vk_handle_cmd_buff, VkCompareOp compare_op)
+{
+    vkCmdSetDepthCompareOp(vk_handle_cmd_buff, compare_op);
+}
+
+void cmd_set_color_blend_enable_EXT(VkCommandBuffer vk_handle_cmd_buff, uint32_t first_attachment, const std::vector<VkBool32>& blend_enable_vec)
+{
+    if (vkCmdSetColorBlendEnableEXT == VK_NULL_HANDLE)
+        return;
+
+    vkCmdSetColorBlendEnableEXT(vk_handle_cmd_buff, first_attachment, static_cast<uint32_t>(blend_enable_vec.size()), blend_enable_vec.data());
+}
+
+void cmd_set_color_blend_equation_EXT(VkCommandBuffer vk_handle_cmd_buff, uint32_t first_attachment, const std::vector<VkColorBlendEquationEXT>& blend_equation_vec)
+{
+    if (vkCmdSetColorBlendEquationEXT == VK_NULL_HANDLE)
+        return;
+
+    vkCmdSetColorBlendEquationEXT(vk_handle_cmd_buff, first_attachment, static_cast<uint32_t>(blend_equation_vec.size()), blend_equation_vec.data());
+}
+
+void cmd_set_color_write_mask_EXT(VkCommandBuffer vk_handle_cmd_buff, uint32_t first_attachment, const std::vector<VkColorComponentFlags>& write_mask_vec)
+{
+    if (vkCmdSetColorWriteMaskEXT == VK_NULL_HANDLE)
+        return;
+
+    vkCmdSetColorWriteMaskEXT(vk_handle_cmd_buff, first_attachment, static_cast<uint32_t>(write_mask_vec.size()), write_mask_vec.data());
+}
+
+VkDeviceSize get_desc_set_layout_size_EXT(VkDescriptorSetLayout vk_handle_desc_set_layout)
+{
+    VkDeviceSize size = 0u;
+    vkGetDescriptorSetLayoutSizeEXT(vk_handle_device, vk_handle_desc_set_layout, &size);
+    return size;
+}
+
+VkDeviceSize get_desc_set_layout_binding_offset_EXT(VkDescriptorSetLayout vk_handle_desc_set_layout, uint32_t binding)
+{
+    VkDeviceSize offset = 0u;
+    vkGetDescriptorSetLayoutBindingOffsetEXT(vk_handle_device, vk_handle_desc_set_layout, binding, &offset);
+    return offset;
+}
+
+void get_descriptor_EXT(const VkDescriptorGetInfoEXT& descriptor_get_info, size_t descriptor_size, void* p_descriptor)
+{
+    vkGetDescriptorEXT(vk_handle_device, &descriptor_get_info, descriptor_size, p_descriptor);
+}
+
+void cmd_bind_desc_buffers_EXT(VkCommandBuffer vk_handle_cmd_buff, const std::vector<VkDescriptorBufferBindingInfoEXT>& binding_info_vec)
+{
+    vkCmdBindDescriptorBuffersEXT(vk_handle_cmd_buff, static_cast<uint32_t>(binding_info_vec.size()), binding_info_vec.data());
+}
+
+void cmd_set_desc_buffer_offsets_EXT(VkCommandBuffer vk_handle_cmd_buff, VkPipelineBindPoint bind_point, VkPipelineLayout vk_handle_pipeline_layout, uint32_t first_set, uint32_t set_count, const uint32_t* p_buffer_indices, const VkDeviceSize* p_offsets)
+{
+    vkCmdSetDescriptorBufferOffsetsEXT(vk_handle_cmd_buff, bind_point, vk_handle_pipeline_layout, first_set, set_count, p_buffer_indices, p_offsets);
+}
+
 void get_latency_timings_NV(VkGetLatencyMarkerInfoNV* latency_marker_info)
 {
     if (vkGetLatencyTimingsNV == VK_NULL_HANDLE)
@@ -798,6 +1831,11 @@ VkSampler create_sampler(const VkSamplerCreateInfo& create_info)
     return vk_handle_sampler;;
 }
 
+void destroy_sampler(const VkSampler vk_handle_sampler)
+{
+    vkDestroySampler(vk_handle_device, vk_handle_sampler, nullptr);
+}
+
 VkImage create_image(const VkImageCreateInfo& create_info)
 {
     VkImage image = VK_NULL_HANDLE;
@@ -851,14 +1889,21 @@ VkBuffer create_buffer(const VkBufferCreateInfo& create_info)
     return vk_handle_buffer;
 }
 
-VkDeviceMemory allocate_buffer_memory(const VkBuffer vk_handle_buffer, const VkMemoryPropertyFlags flags, VkDeviceSize& size)
+VkDeviceMemory allocate_buffer_memory(const VkBuffer vk_handle_buffer, const VkMemoryPropertyFlags flags, VkDeviceSize& size, const VkMemoryAllocateFlags allocate_flags)
 {
     VkMemoryRequirements memory_requirements;
     vkGetBufferMemoryRequirements(vk_handle_device, vk_handle_buffer, &memory_requirements);
 
+    const VkMemoryAllocateFlagsInfo memory_alloc_flags_info {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO,
+        .pNext = nullptr,
+        .flags = allocate_flags,
+        .deviceMask = 0u,
+    };
+
     const VkMemoryAllocateInfo memory_alloc_info{
         .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .pNext = nullptr,
+        .pNext = (allocate_flags != 0x0) ? &memory_alloc_flags_info : nullptr,
         .allocationSize = memory_requirements.size,
         .memoryTypeIndex = get_memory_type_idx(memory_requirements.memoryTypeBits, flags),
     };
@@ -881,6 +1926,17 @@ void destroy_buffer(const VkBuffer vk_handle_buffer)
     vkDestroyBuffer(vk_handle_device, vk_handle_buffer, nullptr);
 }
 
+VkDeviceAddress get_buffer_device_address(const VkBuffer vk_handle_buffer)
+{
+    const VkBufferDeviceAddressInfo address_info {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+        .pNext = nullptr,
+        .buffer = vk_handle_buffer,
+    };
+
+    return vkGetBufferDeviceAddress(vk_handle_device, &address_info);
+}
+
 VkShaderModule create_shader_module(const VkShaderModuleCreateInfo& create_info)
 {
     VkShaderModule vk_handle_shader_module = VK_NULL_HANDLE;
@@ -894,13 +1950,103 @@ void destroy_shader_module(const VkShaderModule vk_handle_shader_module)
 }
 
 
-VkPipeline create_graphics_pipeline(const VkGraphicsPipelineCreateInfo& create_info)
+static std::pair<const VkPipelineShaderStageCreateInfo*, uint32_t> get_pipeline_stages(const VkGraphicsPipelineCreateInfo& create_info)
+{
+    return {create_info.pStages, create_info.stageCount};
+}
+
+static std::pair<const VkPipelineShaderStageCreateInfo*, uint32_t> get_pipeline_stages(const VkComputePipelineCreateInfo& create_info)
+{
+    return {&create_info.stage, 1u};
+}
+
+// Chains VkPipelineCreationFeedbackCreateInfo (core in 1.3) into copies of the create infos and keeps the
+// feedback while recording is enabled.
+template<typename T, typename F>
+static VkResult create_pipelines_with_feedback(const uint32_t create_info_count, const T* const p_create_infos, const char* const* p_names, VkPipeline* const p_pipelines, F&& create_func)
+{
+    std::vector<T> create_info_vec(p_create_infos, p_create_infos + create_info_count);
+    std::vector<VkPipelineCreationFeedback> pipeline_feedback_vec(create_info_count);
+    std::vector<std::vector<VkPipelineCreationFeedback>> stage_feedback_vec(create_info_count);
+    std::vector<VkPipelineCreationFeedbackCreateInfo> create_info_feedback_vec(create_info_count);
+
+    for (uint32_t i = 0; i < create_info_count; i++)
+    {
+        stage_feedback_vec[i].resize(get_pipeline_stages(create_info_vec[i]).second);
+
+        create_info_feedback_vec[i] = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO,
+            .pNext = create_info_vec[i].pNext,
+            .pPipelineCreationFeedback = &pipeline_feedback_vec[i],
+            .pipelineStageCreationFeedbackCount = static_cast<uint32_t>(stage_feedback_vec[i].size()),
+            .pPipelineStageCreationFeedbacks = stage_feedback_vec[i].data(),
+        };
+
+        create_info_vec[i].pNext = &create_info_feedback_vec[i];
+    }
+
+    const VkResult result = create_func(create_info_count, create_info_vec.data(), p_pipelines);
+
+    std::lock_guard<std::mutex> lock(pipeline_creation_feedback_mutex);
+
+    if (!record_pipeline_creation_feedback)
+        return result;
+
+    for (uint32_t i = 0; i < create_info_count; i++)
+    {
+        if (p_pipelines[i] == VK_NULL_HANDLE)
+            continue;
+
+        PipelineCreationFeedback& feedback = pipeline_creation_feedback_vec.emplace_back();
+        feedback.name = (p_names != nullptr && p_names[i] != nullptr) ? p_names[i] : "Unnamed";
+        feedback.pipeline = pipeline_feedback_vec[i];
+
+        const auto [p_stages, stage_count] = get_pipeline_stages(create_info_vec[i]);
+
+        for (uint32_t stage_idx = 0; stage_idx < stage_count; stage_idx++)
+            feedback.stage_vec.push_back({p_stages[stage_idx].stage, stage_feedback_vec[i][stage_idx]});
+    }
+
+    return result;
+}
+
+VkPipeline create_graphics_pipeline(const VkGraphicsPipelineCreateInfo& create_info, const char* name)
+{
+    VkPipeline vk_handle_pipeline = VK_NULL_HANDLE;
+    VK_CHECK(create_graphics_pipelines(1u, &create_info, &vk_handle_pipeline, &name));
+    return vk_handle_pipeline;
+}
+
+VkResult create_graphics_pipelines(const uint32_t create_info_count, const VkGraphicsPipelineCreateInfo* const p_create_infos, VkPipeline* const p_pipelines, const char* const* p_names)
+{
+    return create_pipelines_with_feedback(create_info_count, p_create_infos, p_names, p_pipelines, [](uint32_t count, const VkGraphicsPipelineCreateInfo* p_infos, VkPipeline* p_handles) {
+        return vkCreateGraphicsPipelines(vk_handle_device, vk_handle_pipeline_cache, count, p_infos, nullptr, p_handles);
+    });
+}
+
+VkPipeline create_compute_pipeline(const VkComputePipelineCreateInfo& create_info, const char* name)
 {
     VkPipeline vk_handle_pipeline = VK_NULL_HANDLE;
-    VK_CHECK(vkCreateGraphicsPipelines(vk_handle_device, VK_NULL_HANDLE, 1, &create_info, nullptr, &vk_handle_pipeline));
+
+    VK_CHECK(create_pipelines_with_feedback(1u, &create_info, &name, &vk_handle_pipeline, [](uint32_t count, const VkComputePipelineCreateInfo* p_infos, VkPipeline* p_handles) {
+        return vkCreateComputePipelines(vk_handle_device, vk_handle_pipeline_cache, count, p_infos, nullptr, p_handles);
+    }));
+
     return vk_handle_pipeline;
 }
 
+void set_pipeline_creation_feedback_recording(bool enable)
+{
+    std::lock_guard<std::mutex> lock(pipeline_creation_feedback_mutex);
+    record_pipeline_creation_feedback = enable;
+}
+
+std::vector<PipelineCreationFeedback> take_pipeline_creation_feedback()
+{
+    std::lock_guard<std::mutex> lock(pipeline_creation_feedback_mutex);
+    return std::exchange(pipeline_creation_feedback_vec, {});
+}
+
 void destroy_pipeline(const VkPipeline vk_handle_pipeline)
 {
     vkDestroyPipeline(vk_handle_device, vk_handle_pipeline, nullptr);
@@ -915,6 +2061,11 @@ VkDescriptorPool create_desc_pool(const VkDescriptorPoolCreateInfo& create_info)
     return vk_handle_desc_pool;
 }
 
+void reset_desc_pool(VkDescriptorPool vk_handle_desc_pool)
+{
+    VK_CHECK(vkResetDescriptorPool(vk_handle_device, vk_handle_desc_pool, 0x0));
+}
+
 void destroy_desc_pool(const VkDescriptorPool vk_handle_desc_pool)
 {
     vkDestroyDescriptorPool(vk_handle_device, vk_handle_desc_pool, nullptr);
@@ -939,11 +2090,43 @@ std::vector<VkDescriptorSet> allocate_desc_sets(const VkDescriptorSetAllocateInf
     return vk_handle_desc_set_list;
 }
 
+VkResult allocate_desc_sets(const VkDescriptorSetAllocateInfo& alloc_info, VkDescriptorSet* p_desc_sets)
+{
+    return vkAllocateDescriptorSets(vk_handle_device, &alloc_info, p_desc_sets);
+}
+
 void update_desc_sets(const uint32_t update_count, const VkWriteDescriptorSet* const p_write_desc_set_list, const uint32_t copy_count, const VkCopyDescriptorSet* const p_copy_desc_set_list)
 {
     vkUpdateDescriptorSets(vk_handle_device, update_count, p_write_desc_set_list, copy_count, p_copy_desc_set_list);
 }
 
+void cmd_push_constants(VkCommandBuffer vk_handle_cmd_buff, VkPipelineLayout vk_handle_pipeline_layout, VkShaderStageFlags stage_flags, uint32_t offset, uint32_t size, const void* p_values)
+{
+    vkCmdPushConstants(vk_handle_cmd_buff, vk_handle_pipeline_layout, stage_flags, offset, size, p_values);
+}
+
+void cmd_push_descriptor_set_KHR(VkCommandBuffer vk_handle_cmd_buff, VkPipelineBindPoint bind_point, VkPipelineLayout vk_handle_pipeline_layout, uint32_t set, const std::vector<VkWriteDescriptorSet>& write_desc_set_vec)
+{
+    vkCmdPushDescriptorSetKHR(vk_handle_cmd_buff, bind_point, vk_handle_pipeline_layout, set, static_cast<uint32_t>(write_desc_set_vec.size()), write_desc_set_vec.data());
+}
+
+VkDescriptorUpdateTemplate create_desc_update_template(const VkDescriptorUpdateTemplateCreateInfo& create_info)
+{
+    VkDescriptorUpdateTemplate vk_handle_desc_update_template = VK_NULL_HANDLE;
+    VK_CHECK(vkCreateDescriptorUpdateTemplate(vk_handle_device, &create_info, nullptr, &vk_handle_desc_update_template));
+    return vk_handle_desc_update_template;
+}
+
+void destroy_desc_update_template(VkDescriptorUpdateTemplate vk_handle_desc_update_template)
+{
+    vkDestroyDescriptorUpdateTemplate(vk_handle_device, vk_handle_desc_update_template, nullptr);
+}
+
+void update_desc_set_with_template(VkDescriptorSet vk_handle_desc_set, VkDescriptorUpdateTemplate vk_handle_desc_update_template, const void* p_data)
+{
+    vkUpdateDescriptorSetWithTemplate(vk_handle_device, vk_handle_desc_set, vk_handle_desc_update_template, p_data);
+}
+
 VkPipelineLayout create_pipeline_layout(const VkPipelineLayoutCreateInfo& create_info)
 {
     VkPipelineLayout vk_handle_pipeline_layout = VK_NULL_HANDLE;
@@ -972,12 +2155,6 @@ void free_memory(const VkDeviceMemory vk_handle_memory)
 }
 
 
-void queue_submit(const uint32_t submit_count, const VkSubmitInfo* const p_submit_infos, const VkFence vk_handle_signal_fence)
-{
-    vkQueueSubmit(vk_handle_queue, submit_count, p_submit_infos, vk_handle_signal_fence);
-}
-
-
 
 uint32_t get_queue_family_idx()
 {